@@ -0,0 +1,50 @@
+/**
+* A three-stage numeric pipeline called once per element against fff::batched.
+*/
+
+#include <numeric>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/batch.hpp"
+
+namespace {
+
+    const auto pipeline = fff::PipelineFactory()(fff::simd::lanewise([](auto x) {return x * 2.0f;}),
+                                                 fff::simd::lanewise([](auto x) {return x + 1.0f;}),
+                                                 fff::simd::lanewise([](auto x) {return x * x;}));
+
+    auto input(std::size_t n) -> std::vector<float> {
+        std::vector<float> v(n);
+        std::iota(v.begin(), v.end(), 0.0f);
+        return v;
+    }
+
+    void BM_PerElement(benchmark::State &state) {
+        const auto in = input(state.range(0));
+        std::vector<float> out(in.size());
+        for (auto _ : state) {
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                out[i] = pipeline(in[i]);
+            }
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_PerElement)->Range(1 << 10, 1 << 20);
+
+    void BM_Batched(benchmark::State &state) {
+        const auto in = input(state.range(0));
+        std::vector<float> out(in.size());
+        const auto batched = fff::batched(pipeline);
+        for (auto _ : state) {
+            batched(std::span<const float>(in), std::span<float>(out));
+            benchmark::DoNotOptimize(out.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_Batched)->Range(1 << 10, 1 << 20);
+}
+
+BENCHMARK_MAIN();
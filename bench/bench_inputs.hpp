@@ -0,0 +1,30 @@
+#ifndef UNDERSCORE_CPP_BENCH_INPUTS_HPP
+#define UNDERSCORE_CPP_BENCH_INPUTS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+* The inputs of the benchmarks: the same pseudo-random values on every run
+*/
+namespace bench {
+
+    /**
+    * n elements make(i, s), where s is the i-th value of a linear congruential generator seeded with 12345.
+    * @example bench::lcg_inputs\<std::uint32_t>(4096, [](std::size_t, std::uint32_t s) {return s >> 8;})
+    */
+    template<typename T, class Make>
+    auto lcg_inputs(std::size_t n, Make make) -> std::vector<T> {
+        std::vector<T> v;
+        v.reserve(n);
+        std::uint32_t s = 12345;
+        for (std::size_t i = 0; i < n; ++i) {
+            s = s * 1664525 + 1013904223;
+            v.push_back(make(i, s));
+        }
+        return v;
+    }
+}
+
+#endif//UNDERSCORE_CPP_BENCH_INPUTS_HPP
@@ -0,0 +1,473 @@
+/**
+* Every fff combinator against the loop or std facility it replaces.
+* Each pair runs the same work, so the ratio of the two is the overhead of the combinator;
+* for the zero-cost ones (Pipeline, Parallel, Overload, static_l_bind...) it should be 1.
+* Run with --benchmark_format=json, or build the bench_json target, to get machine-readable results.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/bind.hpp"
+#include "../ffffff/functors.hpp"
+#include "../ffffff/overload.hpp"
+#include "../ffffff/pipeline.hpp"
+#include "../ffffff/reducible.hpp"
+#include "../ffffff/utils.hpp"
+
+namespace {
+
+    template<typename T>
+    auto make_input(std::size_t n) -> std::vector<T> {
+        std::vector<T> v(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            if constexpr (std::is_same_v<T, std::string>) {
+                v[i] = std::to_string(i);
+            } else {
+                v[i] = static_cast<T>(i);
+            }
+        }
+        return v;
+    }
+
+    // the same work for every element type: something cheap that cannot be folded away
+    template<typename T>
+    auto step(const T &x) -> T {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return x + '!';
+        } else {
+            return x * 3 + 1;
+        }
+    }
+
+    template<typename T>
+    auto keep(const T &x) -> bool {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return x.back() % 2 == 0;
+        } else {
+            return static_cast<long long>(x) % 2 == 0;
+        }
+    }
+
+    void sizes(benchmark::internal::Benchmark *b) {
+        b->RangeMultiplier(16)->Range(1 << 6, 1 << 18);
+    }
+
+    void string_sizes(benchmark::internal::Benchmark *b) {
+        b->RangeMultiplier(16)->Range(1 << 6, 1 << 14);
+    }
+
+    /*
+    * Map, Filter, Reject, Some
+    */
+
+    template<typename T>
+    void BM_Map_Fff(benchmark::State &state) {
+        const auto in = make_input<T>(state.range(0));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(fff::Map()(in, [](const T &x) {return step(x);}));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template<typename T>
+    void BM_Map_Hand(benchmark::State &state) {
+        const auto in = make_input<T>(state.range(0));
+        for (auto _ : state) {
+            std::vector<T> out(in.size());
+            std::transform(in.begin(), in.end(), out.begin(), [](const T &x) {return step(x);});
+            benchmark::DoNotOptimize(out);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK_TEMPLATE(BM_Map_Fff, int)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Map_Hand, int)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Map_Fff, double)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Map_Hand, double)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Map_Fff, std::string)->Apply(string_sizes);
+    BENCHMARK_TEMPLATE(BM_Map_Hand, std::string)->Apply(string_sizes);
+
+    template<typename T, bool Reject>
+    void BM_Filter_Fff(benchmark::State &state) {
+        const auto in = make_input<T>(state.range(0));
+        for (auto _ : state) {
+            if constexpr (Reject) {
+                benchmark::DoNotOptimize(fff::Reject()(in, [](const T &x) {return keep(x);}));
+            } else {
+                benchmark::DoNotOptimize(fff::Filter()(in, [](const T &x) {return keep(x);}));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template<typename T, bool Reject>
+    void BM_Filter_Hand(benchmark::State &state) {
+        const auto in = make_input<T>(state.range(0));
+        for (auto _ : state) {
+            std::vector<T> out;
+            std::copy_if(in.begin(), in.end(), std::back_inserter(out), [](const T &x) {return keep(x) != Reject;});
+            benchmark::DoNotOptimize(out);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK_TEMPLATE(BM_Filter_Fff, int, false)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Filter_Hand, int, false)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Filter_Fff, double, false)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Filter_Hand, double, false)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Filter_Fff, std::string, false)->Apply(string_sizes);
+    BENCHMARK_TEMPLATE(BM_Filter_Hand, std::string, false)->Apply(string_sizes);
+    BENCHMARK_TEMPLATE(BM_Filter_Fff, int, true)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Filter_Hand, int, true)->Apply(sizes);
+
+    // no element matches, so both scan the whole input
+    template<typename T>
+    void BM_Some_Fff(benchmark::State &state) {
+        const auto in = make_input<T>(state.range(0));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(fff::some(in, [](const T &x) {return x < T();}));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template<typename T>
+    void BM_Some_Hand(benchmark::State &state) {
+        const auto in = make_input<T>(state.range(0));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(std::any_of(in.begin(), in.end(), [](const T &x) {return x < T();}));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK_TEMPLATE(BM_Some_Fff, int)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Some_Hand, int)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Some_Fff, double)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_Some_Hand, double)->Apply(sizes);
+
+    /*
+    * Pipeline of depth N against N nested calls
+    */
+
+    constexpr auto inc = [](int x) {return x + 1;};
+
+    template<std::size_t N>
+    void BM_Pipeline_Fff(benchmark::State &state) {
+        const auto p = [&]<std::size_t ...I>(std::index_sequence<I...>) {
+            return fff::PipelineFactory()(((void) I, inc)...);
+        }(std::make_index_sequence<N>());
+
+        int x = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(p(x));
+        }
+    }
+
+    template<std::size_t N>
+    void BM_Pipeline_Hand(benchmark::State &state) {
+        int x = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            int y = x;
+            for (std::size_t i = 0; i < N; ++i) {
+                y = inc(y);
+            }
+            benchmark::DoNotOptimize(y);
+        }
+    }
+
+    BENCHMARK_TEMPLATE(BM_Pipeline_Fff, 1);
+    BENCHMARK_TEMPLATE(BM_Pipeline_Hand, 1);
+    BENCHMARK_TEMPLATE(BM_Pipeline_Fff, 2);
+    BENCHMARK_TEMPLATE(BM_Pipeline_Hand, 2);
+    BENCHMARK_TEMPLATE(BM_Pipeline_Fff, 4);
+    BENCHMARK_TEMPLATE(BM_Pipeline_Hand, 4);
+    BENCHMARK_TEMPLATE(BM_Pipeline_Fff, 8);
+    BENCHMARK_TEMPLATE(BM_Pipeline_Hand, 8);
+    BENCHMARK_TEMPLATE(BM_Pipeline_Fff, 16);
+    BENCHMARK_TEMPLATE(BM_Pipeline_Hand, 16);
+
+    // a pipeline over a whole vector, with string payloads that must not be copied between stages
+    void BM_PipelineStrings_Fff(benchmark::State &state) {
+        const auto in = make_input<std::string>(state.range(0));
+        const auto p = fff::PipelineFactory()([](std::string s) {return s + 'a';},
+                                              [](std::string s) {return s + 'b';},
+                                              [](std::string s) {return s.size();});
+        for (auto _ : state) {
+            std::size_t total = 0;
+            for (const auto &s : in) {
+                total += p(s);
+            }
+            benchmark::DoNotOptimize(total);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_PipelineStrings_Hand(benchmark::State &state) {
+        const auto in = make_input<std::string>(state.range(0));
+        for (auto _ : state) {
+            std::size_t total = 0;
+            for (const auto &s : in) {
+                std::string t = s + 'a';
+                t = std::move(t) + 'b';
+                total += t.size();
+            }
+            benchmark::DoNotOptimize(total);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK(BM_PipelineStrings_Fff)->Apply(string_sizes);
+    BENCHMARK(BM_PipelineStrings_Hand)->Apply(string_sizes);
+
+    /*
+    * Parallel and Overload dispatch against a direct call
+    */
+
+    constexpr auto on_int = [](int x) {return x * 2;};
+    // no conversion between int and Meters, so each call has exactly one candidate
+    struct Meters {
+        long v;
+    };
+
+    constexpr auto on_meters = [](Meters m) {return m.v / 3;};
+    constexpr auto on_string = [](const std::string &s) {return s.size();};
+
+    void BM_Parallel_Fff(benchmark::State &state) {
+        const auto f = fff::parallel(on_string, on_meters, on_int);
+        int x = 1;
+        Meters y{7};
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(y);
+            benchmark::DoNotOptimize(f(x));
+            benchmark::DoNotOptimize(f(y));
+        }
+    }
+
+    void BM_Overload_Fff(benchmark::State &state) {
+        const auto f = fff::overload(on_string, on_meters, on_int);
+        int x = 1;
+        Meters y{7};
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(y);
+            benchmark::DoNotOptimize(f(x));
+            benchmark::DoNotOptimize(f(y));
+        }
+    }
+
+    void BM_Dispatch_Hand(benchmark::State &state) {
+        int x = 1;
+        Meters y{7};
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(y);
+            benchmark::DoNotOptimize(on_int(x));
+            benchmark::DoNotOptimize(on_meters(y));
+        }
+    }
+
+    BENCHMARK(BM_Parallel_Fff);
+    BENCHMARK(BM_Overload_Fff);
+    BENCHMARK(BM_Dispatch_Hand);
+
+    /*
+    * Reducible_f of 2, 4, 8 arguments against a + b + ...
+    */
+
+    template<std::size_t N>
+    void BM_Reducible_Fff(benchmark::State &state) {
+        const auto add = fff::reducible(std::plus<>());
+        std::array<long, N> a{};
+        std::iota(a.begin(), a.end(), 1);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(a);
+            benchmark::DoNotOptimize(std::apply(add, a));
+        }
+    }
+
+    template<std::size_t N>
+    void BM_Reducible_Hand(benchmark::State &state) {
+        std::array<long, N> a{};
+        std::iota(a.begin(), a.end(), 1);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(a);
+            benchmark::DoNotOptimize(std::apply([](auto ...v) {return (v + ...);}, a));
+        }
+    }
+
+    BENCHMARK_TEMPLATE(BM_Reducible_Fff, 2);
+    BENCHMARK_TEMPLATE(BM_Reducible_Hand, 2);
+    BENCHMARK_TEMPLATE(BM_Reducible_Fff, 4);
+    BENCHMARK_TEMPLATE(BM_Reducible_Hand, 4);
+    BENCHMARK_TEMPLATE(BM_Reducible_Fff, 8);
+    BENCHMARK_TEMPLATE(BM_Reducible_Hand, 8);
+
+    template<typename T>
+    void BM_ReducibleRange_Fff(benchmark::State &state) {
+        const auto in = make_input<T>(state.range(0));
+        const auto add = fff::reducible(std::plus<>());
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(add(in));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    template<typename T>
+    void BM_ReducibleRange_Hand(benchmark::State &state) {
+        const auto in = make_input<T>(state.range(0));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(std::accumulate(in.begin(), in.end(), T()));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    BENCHMARK_TEMPLATE(BM_ReducibleRange_Fff, int)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_ReducibleRange_Hand, int)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_ReducibleRange_Fff, double)->Apply(sizes);
+    BENCHMARK_TEMPLATE(BM_ReducibleRange_Hand, double)->Apply(sizes);
+
+    /*
+    * static_l_bind against std::bind_front and a lambda
+    */
+
+    constexpr auto affine = [](int a, int b, int x) {return a * x + b;};
+
+    void BM_StaticLBind_Fff(benchmark::State &state) {
+        const auto f = fff::static_l_bind<3, 4>(affine);
+        int x = 1;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(f(x));
+        }
+    }
+
+    void BM_BindFront_Std(benchmark::State &state) {
+        const auto f = std::bind_front(affine, 3, 4);
+        int x = 1;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(f(x));
+        }
+    }
+
+    void BM_Bind_Hand(benchmark::State &state) {
+        const auto f = [](int x) {return affine(3, 4, x);};
+        int x = 1;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(f(x));
+        }
+    }
+
+    BENCHMARK(BM_StaticLBind_Fff);
+    BENCHMARK(BM_BindFront_Std);
+    BENCHMARK(BM_Bind_Hand);
+
+    /*
+    * Once_f, Count_f and Fly wrapped around a call, against the bare call
+    */
+
+    void BM_Call_Hand(benchmark::State &state) {
+        int x = 1;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(inc(x));
+        }
+    }
+
+    void BM_Once_Fff(benchmark::State &state) {
+        auto f = fff::once([] {return 42;});
+        f();
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(f());
+        }
+    }
+
+    void BM_Once_Hand(benchmark::State &state) {
+        bool done = false;
+        int value = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(done);
+            if (not done) {
+                value = 42;
+                done = true;
+            }
+            benchmark::DoNotOptimize(value);
+        }
+    }
+
+    void BM_Count_Fff(benchmark::State &state) {
+        const auto f = fff::count(inc);
+        int x = 1;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(f(x));
+        }
+        benchmark::DoNotOptimize(f.get_count());
+    }
+
+    void BM_Count_Hand(benchmark::State &state) {
+        std::uint64_t calls = 0;
+        int x = 1;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            ++calls;
+            benchmark::DoNotOptimize(inc(x));
+        }
+        benchmark::DoNotOptimize(calls);
+    }
+
+    void BM_Fly_Fff(benchmark::State &state) {
+        const auto f = fff::fly(inc);
+        int x = 1;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(f(x));
+        }
+    }
+
+    // a callable too big to be stored inline, so Fly keeps it on the heap
+    void BM_FlyHeap_Fff(benchmark::State &state) {
+        const auto f = fff::fly([table = std::array<int, 64>{1}](int x) {return table[x & 63] + x;});
+        int x = 1;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(f(x));
+        }
+    }
+
+    void BM_FlyHeap_Hand(benchmark::State &state) {
+        const auto f = [table = std::array<int, 64>{1}](int x) {return table[x & 63] + x;};
+        int x = 1;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x);
+            benchmark::DoNotOptimize(f(x));
+        }
+    }
+
+    BENCHMARK(BM_Call_Hand);
+    BENCHMARK(BM_Once_Fff);
+    BENCHMARK(BM_Once_Hand);
+    BENCHMARK(BM_Count_Fff);
+    BENCHMARK(BM_Count_Hand);
+    BENCHMARK(BM_Fly_Fff);
+    BENCHMARK(BM_FlyHeap_Fff);
+    BENCHMARK(BM_FlyHeap_Hand);
+}
+
+BENCHMARK_MAIN();
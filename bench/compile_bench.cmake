@@ -0,0 +1,20 @@
+# Compiles bench/compile_bench.cpp at each of DEPTHS with -ftime-report and prints the time and memory it took.
+# Run through the bench_compile target, or:
+#   cmake -DCOMPILER=g++ -DSOURCE=bench/compile_bench.cpp -DDEPTHS="8;32;128" -P bench/compile_bench.cmake
+foreach (depth ${DEPTHS})
+    execute_process(COMMAND ${COMPILER} -std=c++20 -fsyntax-only -ftime-report -DFFF_DEPTH=${depth} ${SOURCE}
+                    RESULT_VARIABLE result
+                    OUTPUT_QUIET
+                    ERROR_VARIABLE report)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "depth ${depth}: compilation failed\n${report}")
+    endif ()
+
+    # GCC's summary line: user, system and wall seconds, then the memory the compiler allocated
+    string(REGEX MATCH "TOTAL[^\n]*" total "${report}")
+    if (total)
+        message(STATUS "depth ${depth}: ${total}")
+    else ()
+        message(STATUS "depth ${depth}:\n${report}")
+    endif ()
+endforeach ()
@@ -0,0 +1,72 @@
+/**
+* Compile-time cost of the combinators: a Pipeline and a Parallel of FFF_DEPTH distinct stages,
+* built both by the factory and by operator|, a Reducible_f over FFF_DEPTH arguments and nth_among.
+* The bench_compile target compiles it at several depths with -ftime-report. Run, it checks that a stage
+* with state followed by an empty one is stored intact (main returns 1 otherwise).
+*/
+
+#include <cstddef>
+#include <utility>
+
+#include "../ffffff/overload.hpp"
+#include "../ffffff/pipeline.hpp"
+#include "../ffffff/reducible.hpp"
+#include "../ffffff/tmf.hpp"
+
+#ifndef FFF_DEPTH
+#define FFF_DEPTH 8
+#endif
+
+namespace {
+
+    template<std::size_t I>
+    struct Stage {
+        constexpr auto operator()(int x) const noexcept -> int {
+            return x + static_cast<int>(I);
+        }
+    };
+
+    template<std::size_t I>
+    struct Tag {};
+
+    // alternative I of the Parallel takes only Tag<I>
+    template<std::size_t I>
+    struct Alternative {
+        constexpr auto operator()(Tag<I>) const noexcept -> std::size_t {
+            return I;
+        }
+    };
+
+    template<std::size_t ...I>
+    constexpr auto run(std::index_sequence<I...>) -> int {
+        constexpr auto by_factory = fff::PipelineFactory()(Stage<I>()...);
+        constexpr auto by_pipe = (fff::PipelineFactory() | ... | Stage<I>());
+        static_assert(by_factory(0) == by_pipe(0));
+
+        constexpr auto dispatch = fff::parallel(Alternative<I>()...);
+        static_assert(((dispatch(Tag<I>()) == I) and ...));
+
+        constexpr auto sum = fff::reducible([](int a, int b) {return a + b;});
+        static_assert(sum(static_cast<int>(I)...) == by_factory(0));
+
+        static_assert(std::is_same_v<fff::nth_among<sizeof...(I) - 1, Stage<I>...>, Stage<sizeof...(I) - 1>>);
+
+        return by_factory(0);
+    }
+
+    auto twice(int x) noexcept -> int {
+        return 2 * x;
+    }
+
+    // a function pointer followed by an empty lambda: the empty leaf must not overwrite the pointer
+    auto mixed() -> bool {
+        const auto chain = fff::PipelineFactory()(twice, [](int x) {return x + 1;});
+        const auto dispatch = fff::parallel(twice, [](const char *) {return 0;});
+        return chain(3) == 7 and dispatch(4) == 8 and dispatch("") == 0;
+    }
+}
+
+int main() {
+    static_cast<void>(run(std::make_index_sequence<FFF_DEPTH>()));
+    return mixed() ? 0 : 1;
+}
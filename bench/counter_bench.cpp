@@ -0,0 +1,52 @@
+/**
+* Contended increments: one shared atomic or mutex against fff::StripedCounter.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/concurrency.hpp"
+#include "../ffffff/utils.hpp"
+
+namespace {
+
+    void BM_MutexCounter(benchmark::State &state) {
+        static std::mutex m;
+        static std::uint64_t n = 0;
+        for (auto _ : state) {
+            const std::lock_guard lock(m);
+            ++n;
+        }
+    }
+    BENCHMARK(BM_MutexCounter)->ThreadRange(1, 8);
+
+    void BM_SharedAtomic(benchmark::State &state) {
+        static std::atomic<std::uint64_t> n{0};
+        for (auto _ : state) {
+            n.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    BENCHMARK(BM_SharedAtomic)->ThreadRange(1, 8);
+
+    void BM_StripedCounter(benchmark::State &state) {
+        static fff::StripedCounter n;
+        for (auto _ : state) {
+            n.add();
+        }
+    }
+    BENCHMARK(BM_StripedCounter)->ThreadRange(1, 8);
+
+    void BM_ConcurrentCount(benchmark::State &state) {
+        static const auto f = fff::concurrent_count([](int x) {return x + 1;});
+        int x = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x = f(x));
+        }
+    }
+    BENCHMARK(BM_ConcurrentCount)->ThreadRange(1, 8);
+}
+
+BENCHMARK_MAIN();
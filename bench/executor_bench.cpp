@@ -0,0 +1,45 @@
+/**
+* Fork/join overhead of fff::TaskGroup on the work-stealing pool, and a parallel Map on it.
+*/
+
+#include <numeric>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/executor.hpp"
+#include "../ffffff/functors.hpp"
+
+namespace {
+
+    auto fib(int n) -> long {
+        if (n < 2) {
+            return n;
+        }
+        long x = 0;
+        fff::TaskGroup group;
+        group.spawn([&] {x = fib(n - 1);});
+        const long y = fib(n - 2);
+        group.sync();
+        return x + y;
+    }
+
+    void BM_ForkJoinFib(benchmark::State &state) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(fib(static_cast<int>(state.range(0))));
+        }
+    }
+    BENCHMARK(BM_ForkJoinFib)->Arg(15)->Arg(20);
+
+    void BM_ParallelMap(benchmark::State &state) {
+        std::vector<int> v(state.range(0));
+        std::iota(v.begin(), v.end(), 0);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(fff::Map()(fff::execution::par, v, [](int x) {return x * 3 + 1;}));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    BENCHMARK(BM_ParallelMap)->Range(1 << 12, 1 << 20);
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,105 @@
+/**
+* A 10-stage pipeline whose middle stage fails for a given percentage of the inputs:
+* the error thrown as an exception and caught at the end, against returned as an fff::Expected
+* that the Pipeline hands past the remaining stages.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/pipeline.hpp"
+
+#include "bench_inputs.hpp"
+
+namespace {
+
+    enum class Code {
+        rejected,
+    };
+
+    struct Rejected {
+        Code code;
+    };
+
+    int failure_percent = 0;
+
+    constexpr std::size_t depth = 10;
+    constexpr std::size_t failing = depth / 2;
+
+    template<std::size_t I>
+    struct Throwing {
+        auto operator()(std::uint32_t x) const -> std::uint32_t {
+            if (I == failing and x % 100 < static_cast<std::uint32_t>(failure_percent)) {
+                throw Rejected{Code::rejected};
+            }
+            return x * 3 + I;
+        }
+    };
+
+    template<std::size_t I>
+    struct Returning {
+        auto operator()(std::uint32_t x) const -> fff::Expected<std::uint32_t, Code> {
+            if (I == failing and x % 100 < static_cast<std::uint32_t>(failure_percent)) {
+                return fff::Unexpected(Code::rejected);
+            }
+            return x * 3 + I;
+        }
+    };
+
+    template<template<std::size_t> class Stage, std::size_t ...I>
+    auto make_chain(std::index_sequence<I...>) {
+        return fff::PipelineFactory()(Stage<I>()...);
+    }
+
+    auto inputs() -> const std::vector<std::uint32_t> & {
+        static const auto in = bench::lcg_inputs<std::uint32_t>(4096, [](std::size_t, std::uint32_t s) {
+            return s >> 8;
+        });
+        return in;
+    }
+
+    void BM_Exceptions(benchmark::State &state) {
+        failure_percent = static_cast<int>(state.range(0));
+        const auto chain = make_chain<Throwing>(std::make_index_sequence<depth>());
+        std::uint64_t sum = 0, errors = 0;
+        for (auto _ : state) {
+            for (std::uint32_t x : inputs()) {
+                try {
+                    sum += chain(x);
+                } catch (const Rejected &) {
+                    ++errors;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+        benchmark::DoNotOptimize(errors);
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * inputs().size()));
+    }
+    BENCHMARK(BM_Exceptions)->Arg(0)->Arg(1)->Arg(10)->Arg(50);
+
+    void BM_Expected(benchmark::State &state) {
+        failure_percent = static_cast<int>(state.range(0));
+        const auto chain = make_chain<Returning>(std::make_index_sequence<depth>());
+        std::uint64_t sum = 0, errors = 0;
+        for (auto _ : state) {
+            for (std::uint32_t x : inputs()) {
+                const auto r = chain(x);
+                if (r) {
+                    sum += *r;
+                } else {
+                    ++errors;
+                }
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+        benchmark::DoNotOptimize(errors);
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * inputs().size()));
+    }
+    BENCHMARK(BM_Expected)->Arg(0)->Arg(1)->Arg(10)->Arg(50);
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,71 @@
+/**
+* The cost of a dropped call: fff::throttle, fff::debounce and fff::rate_limit, whose reject path
+* is one relaxed load, against a throttle that takes a mutex to check the time.
+* BM_ClockOnly is the steady_clock read that every call makes.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/utils.hpp"
+
+namespace {
+
+    using namespace std::chrono_literals;
+
+    std::atomic<std::uint64_t> flushes{0};
+
+    void flush() noexcept {
+        flushes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void BM_ClockOnly(benchmark::State &state) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(std::chrono::steady_clock::now());
+        }
+    }
+    BENCHMARK(BM_ClockOnly);
+
+    void BM_MutexThrottle(benchmark::State &state) {
+        static std::mutex m;
+        static auto next = std::chrono::steady_clock::time_point();
+        for (auto _ : state) {
+            const auto now = std::chrono::steady_clock::now();
+            const std::lock_guard lock(m);
+            if (now >= next) {
+                next = now + 1h;
+                flush();
+            }
+        }
+    }
+    BENCHMARK(BM_MutexThrottle)->ThreadRange(1, 8);
+
+    void BM_Throttle(benchmark::State &state) {
+        static const auto throttled = fff::throttle(flush, 1h);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(throttled());
+        }
+    }
+    BENCHMARK(BM_Throttle)->ThreadRange(1, 8);
+
+    void BM_Debounce(benchmark::State &state) {
+        static const auto debounced = fff::debounce(flush, 1h);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(debounced());
+        }
+    }
+    BENCHMARK(BM_Debounce)->ThreadRange(1, 8);
+
+    void BM_RateLimit(benchmark::State &state) {
+        static const auto limited = fff::rate_limit(flush, 1.0, 10);
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(limited());
+        }
+    }
+    BENCHMARK(BM_RateLimit)->ThreadRange(1, 8);
+}
+
+BENCHMARK_MAIN();
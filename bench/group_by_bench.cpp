@@ -0,0 +1,82 @@
+/**
+* Grouping 64K integers into 64 keys: one Filter pass per key, a std::unordered_map of vectors,
+* and fff::group_by, sequential and with the parallel policy.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/functors.hpp"
+
+#include "bench_inputs.hpp"
+
+namespace {
+
+    constexpr std::uint32_t keys = 64;
+
+    auto inputs() -> const std::vector<std::uint32_t> & {
+        static const auto in = bench::lcg_inputs<std::uint32_t>(1 << 16, [](std::size_t, std::uint32_t s) {
+            return s >> 8;
+        });
+        return in;
+    }
+
+    constexpr auto key_of = [](std::uint32_t x) noexcept {return x % keys;};
+
+    void BM_FilterPerKey(benchmark::State &state) {
+        for (auto _ : state) {
+            std::vector<std::vector<std::uint32_t>> groups;
+            for (std::uint32_t k = 0; k < keys; ++k) {
+                groups.push_back(fff::Filter()(inputs(), [k](std::uint32_t x) {return key_of(x) == k;}));
+            }
+            benchmark::DoNotOptimize(groups);
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * inputs().size()));
+    }
+    BENCHMARK(BM_FilterPerKey);
+
+    void BM_UnorderedMap(benchmark::State &state) {
+        for (auto _ : state) {
+            std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> groups;
+            for (std::uint32_t x : inputs()) {
+                groups[key_of(x)].push_back(x);
+            }
+            benchmark::DoNotOptimize(groups);
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * inputs().size()));
+    }
+    BENCHMARK(BM_UnorderedMap);
+
+    void BM_GroupBy(benchmark::State &state) {
+        for (auto _ : state) {
+            auto groups = fff::group_by(inputs(), key_of, std::size_t{keys});
+            benchmark::DoNotOptimize(groups);
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * inputs().size()));
+    }
+    BENCHMARK(BM_GroupBy);
+
+    void BM_GroupByParallel(benchmark::State &state) {
+        for (auto _ : state) {
+            auto groups = fff::group_by(fff::execution::par, inputs(), key_of);
+            benchmark::DoNotOptimize(groups);
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * inputs().size()));
+    }
+    BENCHMARK(BM_GroupByParallel)->UseRealTime();
+
+    void BM_CountBy(benchmark::State &state) {
+        for (auto _ : state) {
+            auto counts = fff::count_by(inputs(), key_of, keys);
+            benchmark::DoNotOptimize(counts);
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * inputs().size()));
+    }
+    BENCHMARK(BM_CountBy);
+}
+
+BENCHMARK_MAIN();
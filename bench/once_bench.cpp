@@ -0,0 +1,59 @@
+/**
+* Steady-state cost of fff::once / fff::concurrent_once, against a bare acquire load.
+* After the first call, concurrent_once should cost about as much as the load itself.
+*/
+
+#include <atomic>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/utils.hpp"
+
+namespace {
+
+    std::atomic<bool> published{true};
+
+    void BM_AcquireLoad(benchmark::State &state) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(published.load(std::memory_order_acquire));
+        }
+    }
+    BENCHMARK(BM_AcquireLoad)->ThreadRange(1, 8);
+
+    void BM_Once(benchmark::State &state) {
+        auto f = fff::once([] {return 42;});
+        f();
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(f());
+        }
+    }
+    BENCHMARK(BM_Once);
+
+    void BM_ConcurrentOnce(benchmark::State &state) {
+        static auto f = fff::concurrent_once([] {return 42;});
+        f();
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(f());
+        }
+    }
+    BENCHMARK(BM_ConcurrentOnce)->ThreadRange(1, 8);
+
+    void BM_ConcurrentOnceVoid(benchmark::State &state) {
+        static auto f = fff::concurrent_once([] {});
+        for (auto _ : state) {
+            f();
+            benchmark::ClobberMemory();
+        }
+    }
+    BENCHMARK(BM_ConcurrentOnceVoid)->ThreadRange(1, 8);
+
+    void BM_FunctionLocalStatic(benchmark::State &state) {
+        for (auto _ : state) {
+            static const int v = 42;
+            benchmark::DoNotOptimize(v);
+        }
+    }
+    BENCHMARK(BM_FunctionLocalStatic)->ThreadRange(1, 8);
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+/**
+* A three-stage Pipeline of Filter and Map called over and over on the same input: as it is, every call
+* allocates its intermediate and result vectors, and under fff::recycling they come from fff::pool.
+* The "made" counter is the vectors the pool had to make, summed over ObjectCounter\<std::vector\<...>>::created().
+*/
+
+#include <cstddef>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/functors.hpp"
+#include "../ffffff/pipeline.hpp"
+#include "../ffffff/pool.hpp"
+
+namespace {
+
+    std::vector<int> input(std::size_t n) {
+        std::vector<int> v(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            v[i] = static_cast<int>(i * 7919 % 1000);
+        }
+        return v;
+    }
+
+    auto stages() {
+        return fff::PipelineFactory()(
+            [](const std::vector<int> &in) {return fff::Filter()(in, [](int x) {return x % 3 != 0;});},
+            [](std::vector<int> &&in) {return fff::Map()(std::move(in), [](int x) {return x * 0.25;});},
+            [](std::vector<double> &&in) {return fff::Map()(std::move(in), [](double x) {return static_cast<long>(x);});});
+    }
+
+    void BM_Pipeline(benchmark::State &state) {
+        const auto in = input(static_cast<std::size_t>(state.range(0)));
+        const auto pipeline = stages();
+        for (auto _ : state) {
+            auto out = pipeline(in);
+            benchmark::DoNotOptimize(out.data());
+        }
+    }
+    BENCHMARK(BM_Pipeline)->Arg(256)->Arg(4096)->Arg(65536);
+
+    void BM_RecyclingPipeline(benchmark::State &state) {
+        const auto in = input(static_cast<std::size_t>(state.range(0)));
+        const auto pipeline = fff::recycling(stages());
+        const int made = fff::ObjectCounter<std::vector<int>>::created()
+            + fff::ObjectCounter<std::vector<double>>::created() + fff::ObjectCounter<std::vector<long>>::created();
+        for (auto _ : state) {
+            auto out = pipeline(in);
+            benchmark::DoNotOptimize(out.data());
+            fff::pool<std::vector<long>>::release(std::move(out));
+        }
+        state.counters["made"] = fff::ObjectCounter<std::vector<int>>::created()
+            + fff::ObjectCounter<std::vector<double>>::created() + fff::ObjectCounter<std::vector<long>>::created() - made;
+    }
+    BENCHMARK(BM_RecyclingPipeline)->Arg(256)->Arg(4096)->Arg(65536);
+}
+
+BENCHMARK_MAIN();
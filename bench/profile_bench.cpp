@@ -0,0 +1,36 @@
+/**
+* What fff::profiled adds to a call: the bare function, then timed by steady_clock, by the TSC,
+* and one call out of 16 timed.
+*/
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/profile.hpp"
+
+namespace {
+
+    constexpr auto step = [](int x) noexcept {return x * 3 + 1;};
+
+    void BM_Plain(benchmark::State &state) {
+        int x = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x = step(x));
+        }
+    }
+    BENCHMARK(BM_Plain)->ThreadRange(1, 8);
+
+    template<fff::profile_clock Clock, std::uint32_t Period>
+    void BM_Profiled(benchmark::State &state) {
+        static const auto f = fff::profiled(step, {.sample_period = Period, .clock = Clock});
+        int x = 0;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(x = f(x));
+        }
+    }
+    BENCHMARK(BM_Profiled<fff::profile_clock::steady, 1>)->ThreadRange(1, 8);
+    BENCHMARK(BM_Profiled<fff::profile_clock::tsc, 1>)->ThreadRange(1, 8);
+    BENCHMARK(BM_Profiled<fff::profile_clock::steady, 16>)->ThreadRange(1, 8);
+    BENCHMARK(BM_Profiled<fff::profile_clock::tsc, 16>)->ThreadRange(1, 8);
+}
+
+BENCHMARK_MAIN();
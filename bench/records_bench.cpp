@@ -0,0 +1,80 @@
+/**
+* Filtering a file of 2M 16-byte records: read into a std::vector first and then filtered, against
+* fff::MappedRecords and fff::ChunkedReader, which filter straight from the file with bounded memory.
+* The file is written once to the temporary directory and is in the page cache for every run.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/functors.hpp"
+#include "../ffffff/records.hpp"
+
+#include "bench_inputs.hpp"
+
+namespace {
+
+    struct Trade {
+        std::uint64_t id;
+        std::uint32_t qty;
+        float price;
+    };
+
+    constexpr std::size_t records = std::size_t(1) << 21;
+
+    auto trade_file() -> const std::filesystem::path & {
+        static const std::filesystem::path path = [] {
+            auto p = std::filesystem::temp_directory_path() / "underscore_cpp_records_bench.bin";
+            const auto trades = bench::lcg_inputs<Trade>(records, [](std::size_t i, std::uint32_t s) {
+                return Trade{i, s >> 20, static_cast<float>(s >> 8) / 1000};
+            });
+            std::FILE *f = std::fopen(p.c_str(), "wb");
+            std::fwrite(trades.data(), sizeof(Trade), trades.size(), f);
+            std::fclose(f);
+            return p;
+        }();
+        return path;
+    }
+
+    constexpr auto large = [](const Trade &t) noexcept {return t.qty > 4000;};
+
+    void BM_ReadThenFilter(benchmark::State &state) {
+        for (auto _ : state) {
+            std::vector<Trade> all(std::filesystem::file_size(trade_file()) / sizeof(Trade));
+            std::FILE *f = std::fopen(trade_file().c_str(), "rb");
+            benchmark::DoNotOptimize(std::fread(all.data(), sizeof(Trade), all.size(), f));
+            std::fclose(f);
+            auto out = fff::Filter()(all, large);
+            benchmark::DoNotOptimize(out);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * records * sizeof(Trade)));
+    }
+    BENCHMARK(BM_ReadThenFilter)->Unit(benchmark::kMillisecond);
+
+    void BM_MappedFilter(benchmark::State &state) {
+        for (auto _ : state) {
+            const fff::MappedRecords<Trade> trades(trade_file());
+            auto out = fff::Filter()(trades, large);
+            benchmark::DoNotOptimize(out);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * records * sizeof(Trade)));
+    }
+    BENCHMARK(BM_MappedFilter)->Unit(benchmark::kMillisecond);
+
+    void BM_ChunkedFilter(benchmark::State &state) {
+        for (auto _ : state) {
+            const fff::ChunkedReader<Trade> trades(trade_file(), {static_cast<std::size_t>(state.range(0)), 2});
+            auto out = fff::Filter()(trades, large);
+            benchmark::DoNotOptimize(out);
+        }
+        state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * records * sizeof(Trade)));
+    }
+    BENCHMARK(BM_ChunkedFilter)->Arg(1 << 12)->Arg(1 << 16)->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,92 @@
+/**
+* 1M records of 12 fields, of which a stage reads one or two: std::vector of structs against fff::soa_vector.
+* Summing one field, and filtering on one field then summing price * qty over the survivors
+* (rows copied out by Filter, against a soa_selection of row indices).
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/functors.hpp"
+#include "../ffffff/reducible.hpp"
+
+#include "bench_inputs.hpp"
+
+namespace {
+
+    struct Record {
+        std::uint64_t id;
+        double price;
+        std::uint32_t qty;
+        std::uint32_t venue;
+        double bid, ask, bid_size, ask_size, last, open, high, low;
+    };
+
+    using Columns = fff::soa_vector<std::uint64_t, double, std::uint32_t, std::uint32_t,
+                                    double, double, double, double, double, double, double, double>;
+
+    constexpr std::size_t rows = std::size_t(1) << 20;
+
+    auto records() -> const std::vector<Record> & {
+        static const auto v = bench::lcg_inputs<Record>(rows, [](std::size_t i, std::uint32_t s) {
+            return Record{i, static_cast<double>(s >> 12) / 100, s >> 22, s & 7, 1, 2, 3, 4, 5, 6, 7, 8};
+        });
+        return v;
+    }
+
+    auto columns() -> const Columns & {
+        static const Columns c = [] {
+            Columns out;
+            out.reserve(rows);
+            for (const Record &r : records()) {
+                out.emplace_back(r.id, r.price, r.qty, r.venue, r.bid, r.ask, r.bid_size, r.ask_size,
+                                 r.last, r.open, r.high, r.low);
+            }
+            return out;
+        }();
+        return c;
+    }
+
+    void BM_SumField_Structs(benchmark::State &state) {
+        for (auto _ : state) {
+            auto prices = fff::Map()(records(), [](const Record &r) {return r.price;});
+            benchmark::DoNotOptimize(fff::reduce(prices, std::plus<>(), 0.0));
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+    }
+    BENCHMARK(BM_SumField_Structs);
+
+    void BM_SumField_Columns(benchmark::State &state) {
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(fff::reduce(columns().column<1>(), std::plus<>(), 0.0));
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+    }
+    BENCHMARK(BM_SumField_Columns);
+
+    void BM_FilterThenNotional_Structs(benchmark::State &state) {
+        for (auto _ : state) {
+            auto big = fff::Filter()(records(), [](const Record &r) {return r.qty > 768;});
+            auto notional = fff::Map()(big, [](const Record &r) {return r.price * r.qty;});
+            benchmark::DoNotOptimize(fff::reduce(notional, std::plus<>(), 0.0));
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+    }
+    BENCHMARK(BM_FilterThenNotional_Structs);
+
+    void BM_FilterThenNotional_Columns(benchmark::State &state) {
+        for (auto _ : state) {
+            auto big = fff::Filter()(columns(), fff::columns<2>([](std::uint32_t q) {return q > 768;}));
+            auto notional = fff::Map()(big, fff::columns<1, 2>(std::multiplies<>()));
+            benchmark::DoNotOptimize(fff::reduce(notional, std::plus<>(), 0.0));
+        }
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * rows));
+    }
+    BENCHMARK(BM_FilterThenNotional_Columns);
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,106 @@
+/**
+* Dispatch on a variant of 24 message types with one handler per type, plus a catch-all:
+* std::visit, fff::visit of the same handlers as an Overload and as a Parallel (first match),
+* and a hand-written chain of std::get_if.
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../ffffff/overload.hpp"
+
+#include "bench_inputs.hpp"
+
+namespace {
+
+    constexpr std::size_t kinds = 24;
+
+    template<std::size_t I>
+    struct Message {
+        std::uint32_t payload;
+    };
+
+    template<std::size_t I>
+    struct Handler {
+        auto operator()(const Message<I> &m) const noexcept -> std::uint64_t {
+            return m.payload * (I + 1) + I;
+        }
+    };
+
+    template<std::size_t ...I>
+    auto message_type(std::index_sequence<I...>) -> std::variant<Message<I>...>;
+
+    using Variant = decltype(message_type(std::make_index_sequence<kinds>()));
+
+    template<std::size_t ...I>
+    auto make_overload(std::index_sequence<I...>) {
+        return fff::overload(Handler<I>()...);
+    }
+
+    template<std::size_t ...I>
+    auto make_parallel(std::index_sequence<I...>) {
+        return fff::parallel(Handler<I>()..., [](const auto &) noexcept -> std::uint64_t {return 0;});
+    }
+
+    template<std::size_t ...I>
+    auto get_if_chain(const Variant &v, std::index_sequence<I...>) noexcept -> std::uint64_t {
+        std::uint64_t r = 0;
+        static_cast<void>(((std::get_if<I>(&v) ? (r = Handler<I>()(*std::get_if<I>(&v)), true) : false) or ...));
+        return r;
+    }
+
+    auto inputs() -> const std::vector<Variant> & {
+        static const auto table = []<std::size_t ...I>(std::index_sequence<I...>) {
+            return std::array<Variant (*)(std::uint32_t), kinds>{
+                +[](std::uint32_t x) {return Variant(std::in_place_index<I>, Message<I>{x});}...
+            };
+        }(std::make_index_sequence<kinds>());
+        static const auto in = bench::lcg_inputs<Variant>(4096, [](std::size_t, std::uint32_t s) {
+            return table[(s >> 16) % kinds](s >> 8);
+        });
+        return in;
+    }
+
+    template<class Dispatch>
+    void run(benchmark::State &state, Dispatch &&dispatch) {
+        std::uint64_t sum = 0;
+        for (auto _ : state) {
+            for (const Variant &v : inputs()) {
+                sum += dispatch(v);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * inputs().size()));
+    }
+
+    void BM_StdVisit(benchmark::State &state) {
+        const auto handlers = make_overload(std::make_index_sequence<kinds>());
+        run(state, [&](const Variant &v) {return std::visit(handlers, v);});
+    }
+    BENCHMARK(BM_StdVisit);
+
+    void BM_GetIfChain(benchmark::State &state) {
+        run(state, [](const Variant &v) {return get_if_chain(v, std::make_index_sequence<kinds>());});
+    }
+    BENCHMARK(BM_GetIfChain);
+
+    void BM_FffVisitOverload(benchmark::State &state) {
+        const auto handlers = make_overload(std::make_index_sequence<kinds>());
+        run(state, [&](const Variant &v) {return fff::visit(handlers, v);});
+    }
+    BENCHMARK(BM_FffVisitOverload);
+
+    void BM_FffVisitParallel(benchmark::State &state) {
+        const auto handlers = make_parallel(std::make_index_sequence<kinds>());
+        run(state, [&](const Variant &v) {return handlers.visit(v);});
+    }
+    BENCHMARK(BM_FffVisitParallel);
+}
+
+BENCHMARK_MAIN();
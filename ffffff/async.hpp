@@ -0,0 +1,476 @@
+#ifndef UNDERSCORE_CPP_ASYNC_HPP
+#define UNDERSCORE_CPP_ASYNC_HPP
+
+#include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "multiargs.hpp"
+#include "pipeline.hpp"
+#include "tmf.hpp"
+#include "utils.hpp"
+
+/*
+* fff::Task, fff::sync_wait
+*/
+namespace fff {
+
+    namespace liated {
+
+        template<typename T>
+        concept awaiter = requires (T &t, std::coroutine_handle<> h) {
+            { t.await_ready() } -> std::convertible_to<bool>;
+            t.await_suspend(h);
+            t.await_resume();
+        };
+
+        template<typename T>
+        concept has_member_co_await = requires (T &&t) {
+            { std::forward<T>(t).operator co_await() } -> awaiter;
+        };
+
+        template<typename T>
+        concept has_free_co_await = requires (T &&t) {
+            { operator co_await(std::forward<T>(t)) } -> awaiter;
+        };
+    }
+
+    /**
+    * Whether co_await can be applied to T (in a coroutine that does not transform its operands).
+    */
+    template<typename T>
+    concept awaitable = liated::awaiter<std::remove_reference_t<T>>
+        or liated::has_member_co_await<T>
+        or liated::has_free_co_await<T>;
+
+    namespace liated {
+
+        template<awaitable T>
+        constexpr decltype(auto) get_awaiter(T &&t) {
+            if constexpr (has_member_co_await<T>) {
+                return std::forward<T>(t).operator co_await();
+            } else if constexpr (has_free_co_await<T>) {
+                return operator co_await(std::forward<T>(t));
+            } else {
+                return std::forward<T>(t);
+            }
+        }
+    }
+
+    /**
+    * The type of co_await t.
+    */
+    template<awaitable T>
+    using await_result_t = decltype(liated::get_awaiter(std::declval<T>()).await_resume());
+
+    template<typename T = void>
+    class Task;
+
+    namespace liated {
+
+        template<typename T>
+        class TaskPromiseBase {
+            std::coroutine_handle<> continuation = std::noop_coroutine();
+
+            struct FinalAwaiter {
+                constexpr bool await_ready() const noexcept {
+                    return false;
+                }
+
+                template<typename P>
+                auto await_suspend(std::coroutine_handle<P> h) const noexcept -> std::coroutine_handle<> {
+                    return h.promise().continuation;
+                }
+
+                constexpr void await_resume() const noexcept {}
+            };
+
+        protected:
+            std::variant<std::monostate, null_or_t<T>, std::exception_ptr> result;
+
+        public:
+            auto initial_suspend() const noexcept -> std::suspend_always {
+                return {};
+            }
+
+            auto final_suspend() const noexcept -> FinalAwaiter {
+                return {};
+            }
+
+            void unhandled_exception() noexcept {
+                result.template emplace<2>(std::current_exception());
+            }
+
+            void set_continuation(std::coroutine_handle<> h) noexcept {
+                continuation = h;
+            }
+
+            auto take() -> T {
+                if (result.index() == 2) {
+                    std::rethrow_exception(std::get<2>(result));
+                }
+                if constexpr (not std::is_void_v<T>) {
+                    return std::move(std::get<1>(result));
+                }
+            }
+        };
+
+        template<typename T>
+        struct TaskPromise : TaskPromiseBase<T> {
+            auto get_return_object() noexcept -> Task<T>;
+
+            template<typename U>
+                requires std::constructible_from<T, U>
+            void return_value(U &&u) {
+                this->result.template emplace<1>(std::forward<U>(u));
+            }
+        };
+
+        template<>
+        struct TaskPromise<void> : TaskPromiseBase<void> {
+            auto get_return_object() noexcept -> Task<void>;
+
+            void return_void() noexcept {
+                result.emplace<1>();
+            }
+        };
+    }
+
+    /**
+    * A lazily started coroutine that produces a T.
+    * Nothing runs until the Task is co_awaited (or passed to sync_wait); the awaiting coroutine is then
+    * suspended and resumed by symmetric transfer when the Task finishes, without growing the stack.
+    * Exceptions thrown in the coroutine are rethrown by co_await.
+    * @example auto fetch(int id) -> fff::Task\<std::string> { auto r = co_await rpc(id); co_return r.body; }
+    */
+    template<typename T>
+    class [[nodiscard]] Task {
+    public:
+        using promise_type = liated::TaskPromise<T>;
+        using value_type = T;
+
+    private:
+        friend promise_type;
+
+        std::coroutine_handle<promise_type> h;
+
+        explicit Task(std::coroutine_handle<promise_type> h) noexcept : h(h) {}
+
+        struct Awaiter {
+            std::coroutine_handle<promise_type> h;
+
+            bool await_ready() const noexcept {
+                return not h or h.done();
+            }
+
+            auto await_suspend(std::coroutine_handle<> caller) const noexcept -> std::coroutine_handle<> {
+                h.promise().set_continuation(caller);
+                return h;
+            }
+
+            auto await_resume() const -> T {
+                return h.promise().take();
+            }
+        };
+
+    public:
+        Task(Task &&other) noexcept : h(std::exchange(other.h, nullptr)) {}
+
+        Task &operator=(Task &&other) noexcept {
+            if (this != &other) {
+                if (h) {
+                    h.destroy();
+                }
+                h = std::exchange(other.h, nullptr);
+            }
+            return *this;
+        }
+
+        ~Task() {
+            if (h) {
+                h.destroy();
+            }
+        }
+
+        auto operator co_await() const & noexcept -> Awaiter {
+            return Awaiter{h};
+        }
+
+        auto operator co_await() const && noexcept -> Awaiter {
+            return Awaiter{h};
+        }
+
+        auto done() const noexcept -> bool {
+            return h and h.done();
+        }
+    };
+
+    namespace liated {
+
+        template<typename T>
+        auto TaskPromise<T>::get_return_object() noexcept -> Task<T> {
+            return Task<T>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+        }
+
+        inline auto TaskPromise<void>::get_return_object() noexcept -> Task<void> {
+            return Task<void>{std::coroutine_handle<TaskPromise>::from_promise(*this)};
+        }
+
+        /**
+        * A coroutine that starts at once and frees itself at the end, used to drive sync_wait.
+        */
+        struct Detached {
+            struct promise_type {
+                auto get_return_object() const noexcept -> Detached {
+                    return {};
+                }
+                auto initial_suspend() const noexcept -> std::suspend_never {
+                    return {};
+                }
+                auto final_suspend() const noexcept -> std::suspend_never {
+                    return {};
+                }
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept {
+                    std::terminate();
+                }
+            };
+        };
+
+        struct SyncWaitState {
+            std::mutex m;
+            std::condition_variable cv;
+            bool done = false;
+            std::exception_ptr error;
+        };
+
+        template<typename Aw, typename Slot>
+        auto sync_wait_driver(Aw &&aw, Slot &slot, SyncWaitState &state) -> Detached {
+            try {
+                if constexpr (std::is_void_v<await_result_t<Aw>>) {
+                    co_await std::forward<Aw>(aw);
+                } else {
+                    slot.emplace(co_await std::forward<Aw>(aw));
+                }
+            }
+            catch (...) {
+                state.error = std::current_exception();
+            }
+
+            const std::lock_guard lock(state.m);
+            state.done = true;
+            state.cv.notify_one();
+        }
+    }
+
+    namespace fs {
+        struct SyncWait_f {
+            /**
+            * Runs an awaitable to completion and blocks the calling thread until then.
+            * The awaitable may finish on another thread (an I/O completion, a thread pool);
+            * its result or exception is handed back here.
+            */
+            template<awaitable Aw>
+            auto operator()(Aw &&aw) const -> await_result_t<Aw> {
+                using R = await_result_t<Aw>;
+
+                std::optional<null_or_t<std::remove_reference_t<R>>> slot;
+                liated::SyncWaitState state;
+
+                liated::sync_wait_driver(std::forward<Aw>(aw), slot, state);
+
+                std::unique_lock lock(state.m);
+                state.cv.wait(lock, [&state] {return state.done;});
+
+                if (state.error) {
+                    std::rethrow_exception(state.error);
+                }
+                if constexpr (not std::is_void_v<R>) {
+                    return std::move(*slot);
+                }
+            }
+        };
+    }
+
+    constexpr inline fs::SyncWait_f sync_wait;
+}
+
+/*
+* fff::AsyncPipeline
+*/
+namespace fff {
+
+    namespace liated {
+
+        /**
+        * Wraps a plain value so it can be co_awaited without suspending.
+        */
+        template<typename T>
+        struct ReadyAwaiter {
+            T value;
+
+            constexpr bool await_ready() const noexcept {
+                return true;
+            }
+            constexpr void await_suspend(std::coroutine_handle<>) const noexcept {}
+            constexpr auto await_resume() -> T {
+                return std::move(value);
+            }
+        };
+
+        template<typename T>
+        constexpr decltype(auto) as_awaitable(T &&t) {
+            if constexpr (awaitable<T>) {
+                return std::forward<T>(t);
+            } else {
+                return ReadyAwaiter<std::decay_t<T>>{std::forward<T>(t)};
+            }
+        }
+
+        /**
+        * The value a stage produces once awaited, or the stage's result itself if it is not awaitable.
+        */
+        template<typename R>
+        struct awaited {
+            using type = std::decay_t<R>;
+        };
+
+        template<awaitable R>
+        struct awaited<R> {
+            using type = std::decay_t<await_result_t<R>>;
+        };
+
+        template<typename R>
+        using awaited_t = typename awaited<R>::type;
+
+        template<class Stage, typename In>
+        using stage_result_t = awaited_t<decltype(call_stage(std::declval<const Stage &>(), std::declval<In>()))>;
+
+        /**
+        * The awaited outputs of every stage, for a first stage called with Args.
+        */
+        template<typename In, class ...Stages>
+        struct async_chain {
+            using outputs = std::tuple<>;
+        };
+
+        template<typename In, class S, class ...Stages>
+        struct async_chain<In, S, Stages...> {
+            using out = stage_result_t<S, In>;
+            using outputs = decltype(std::tuple_cat(std::declval<std::tuple<out>>(),
+                                                    std::declval<typename async_chain<out, Stages...>::outputs>()));
+        };
+    }
+
+    /**
+    * An asynchronous pipeline. Calling it gives a Task that runs the stages in order: each stage may return
+    * a plain value or something awaitable (a Task, an I/O awaitable...), and the coroutine suspends only at the
+    * awaitable ones, so a few threads can keep many calls in flight while their stages wait on I/O.
+    * A MultiReturn output is spread over the parameters of the next stage.\n
+    * The whole chain runs in one coroutine frame; synchronous stages cost what they cost in Pipeline.
+    * @example auto handle = fff::async_pipeline | parse | lookup_rpc | render; co_await handle(request);
+    * @warning the arguments and the stages are copied into the coroutine, since it runs after the call returns
+    */
+    template<class ...Stages>
+    class AsyncPipeline {
+        template<class ...>
+        friend class AsyncPipeline;
+
+        [[no_unique_address]] std::tuple<Stages...> stages;
+
+        constexpr static std::size_t size = sizeof...(Stages);
+
+        template<typename ...Args>
+        using outputs = typename liated::async_chain<MultiReturn<std::decay_t<Args>...>, Stages...>::outputs;
+
+        template<typename ...Args>
+        using result = std::tuple_element_t<size - 1, outputs<Args...>>;
+
+        template<typename R, typename In, std::size_t ...I>
+        static auto run(std::tuple<Stages...> stages, In in, std::index_sequence<I...>) -> Task<R> {
+            using Outputs = typename liated::async_chain<In, Stages...>::outputs;
+            using States = std::tuple<std::optional<std::tuple_element_t<I, Outputs>>...>;
+            constexpr std::size_t last = size - 1;
+
+            // outputs of stage 0 .. last - 1, every one fed to the next stage
+            States st;
+            (std::get<I>(st).emplace(co_await liated::as_awaitable(
+                liated::call_stage(std::get<I>(stages), [&]() -> decltype(auto) {
+                    if constexpr (I == 0) {
+                        return std::move(in);
+                    } else {
+                        return std::move(*std::get<I - 1>(st));
+                    }
+                }()))), ...);
+
+            auto &&last_in = [&]() -> decltype(auto) {
+                if constexpr (last == 0) {
+                    return std::move(in);
+                } else {
+                    return std::move(*std::get<last - 1>(st));
+                }
+            }();
+
+            using LastResult = decltype(liated::call_stage(std::get<last>(stages), std::move(last_in)));
+            if constexpr (std::is_void_v<LastResult>) {
+                liated::call_stage(std::get<last>(stages), std::move(last_in));
+            } else if constexpr (std::is_void_v<R>) {
+                co_await liated::as_awaitable(liated::call_stage(std::get<last>(stages), std::move(last_in)));
+            } else {
+                co_return co_await liated::as_awaitable(liated::call_stage(std::get<last>(stages), std::move(last_in)));
+            }
+        }
+
+    public:
+        constexpr explicit AsyncPipeline(std::tuple<Stages...> stages) noexcept : stages(std::move(stages)) {}
+
+        /**
+        * @return a Task that has not started yet
+        */
+        template<typename ...Args>
+        auto operator()(Args &&...args) const -> Task<result<Args...>> {
+            return run<result<Args...>>(stages,
+                                        MultiReturn<std::decay_t<Args>...>(std::forward<Args>(args)...),
+                                        std::make_index_sequence<size - 1>());
+        }
+
+        template<class G>
+        constexpr auto operator|(G &&g) const & -> AsyncPipeline<Stages..., std::decay_t<G>> {
+            return AsyncPipeline<Stages..., std::decay_t<G>>{
+                std::tuple_cat(stages, std::tuple<std::decay_t<G>>(std::forward<G>(g)))};
+        }
+
+        template<class G>
+        constexpr auto operator|(G &&g) && -> AsyncPipeline<Stages..., std::decay_t<G>> {
+            return AsyncPipeline<Stages..., std::decay_t<G>>{
+                std::tuple_cat(std::move(stages), std::tuple<std::decay_t<G>>(std::forward<G>(g)))};
+        }
+    };
+
+    struct AsyncPipelineFactory {
+        template<class ...Fs>
+        constexpr auto operator()(Fs &&...fs) const -> AsyncPipeline<std::decay_t<Fs>...> {
+            return AsyncPipeline<std::decay_t<Fs>...>{std::tuple<std::decay_t<Fs>...>(std::forward<Fs>(fs)...)};
+        }
+
+        template<class F>
+        constexpr auto operator|(F &&f) const -> AsyncPipeline<std::decay_t<F>> {
+            return operator()(std::forward<F>(f));
+        }
+    };
+
+    /**
+    * @example fff::async_pipeline(parse, lookup_rpc, render), or fff::async_pipeline | parse | lookup_rpc | render
+    */
+    constexpr inline AsyncPipelineFactory async_pipeline;
+}
+
+#endif//UNDERSCORE_CPP_ASYNC_HPP
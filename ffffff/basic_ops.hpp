@@ -181,4 +181,34 @@ namespace fff {
     inline constexpr convert_to_f<T> convert_to;
 }
 
+/**
+* fff::(Some Binary Operators)
+*/
+
+namespace fff {
+    struct minimum_f {
+        template<typename T, typename U>
+        constexpr auto operator()(T &&t, U &&u) const
+            noexcept(noexcept(u < t))
+                -> std::common_type_t<T, U>
+        {
+            return u < t ? std::forward<U>(u) : std::forward<T>(t);
+        }
+    };
+
+    inline constexpr minimum_f minimum;
+
+    struct maximum_f {
+        template<typename T, typename U>
+        constexpr auto operator()(T &&t, U &&u) const
+            noexcept(noexcept(t < u))
+                -> std::common_type_t<T, U>
+        {
+            return t < u ? std::forward<U>(u) : std::forward<T>(t);
+        }
+    };
+
+    inline constexpr maximum_f maximum;
+}
+
 #endif //UNDERSCORE_CPP_BASIC_OPS_HPP
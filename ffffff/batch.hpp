@@ -0,0 +1,310 @@
+#ifndef UNDERSCORE_CPP_BATCH_HPP
+#define UNDERSCORE_CPP_BATCH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "multiargs.hpp"
+#include "pipeline.hpp"
+#include "simd.hpp"
+
+/*
+* fff::batched : a Pipeline that moves spans of inputs through its stages instead of single values
+*/
+namespace fff {
+
+    namespace liated {
+
+        template<class S, typename In>
+        concept elementwise_stage = (mr<In> and applicable<const S &, const In &>)
+            or (not_mr<In> and std::invocable<const S &, const In &>);
+
+        /**
+        * A stage that takes a whole batch: s(std::span\<const In>, std::span\<Out>) writes out[i] for every in[i].
+        */
+        template<class S, typename In, typename Out>
+        concept span_stage = std::invocable<const S &, std::span<const In>, std::span<Out>>;
+
+        /**
+        * The element type a stage makes from an In: what it returns for one element,
+        * or S::output_type for a stage that only has the span overload.
+        */
+        template<class S, typename In>
+        struct batch_output {
+            using type = typename S::output_type;
+        };
+
+        template<class S, typename In>
+            requires elementwise_stage<S, In>
+        struct batch_output<S, In> {
+            using type = std::decay_t<decltype(call_stage(std::declval<const S &>(), std::declval<const In &>()))>;
+        };
+
+        /**
+        * std::tuple\<In, the output of stage 0, ..., the output of the last stage>
+        */
+        template<typename In, class ...Stages>
+        struct batch_chain {
+            using types = std::tuple<In>;
+        };
+
+        template<typename In, class S, class ...Stages>
+        struct batch_chain<In, S, Stages...> {
+            using out = typename batch_output<S, In>::type;
+            static_assert(not std::is_void_v<out>, "fff::batched : every stage must return a value");
+
+            using types = decltype(std::tuple_cat(std::declval<std::tuple<In>>(),
+                                                  std::declval<typename batch_chain<out, Stages...>::types>()));
+        };
+
+        /**
+        * n value-initialized T between two stages. Unlike a std::vector\<bool>, a buffer of bool holds real bools,
+        * so that every buffer can be handed to a stage as a std::span.
+        */
+        template<typename T>
+        class BatchBuffer {
+            std::unique_ptr<T[]> p;
+            std::size_t n;
+
+        public:
+            explicit BatchBuffer(std::size_t n) : p(std::make_unique<T[]>(n)), n(n) {}
+
+            auto data() const noexcept -> T * {
+                return p.get();
+            }
+
+            auto size() const noexcept -> std::size_t {
+                return n;
+            }
+
+            auto operator[](std::size_t i) const noexcept -> T & {
+                return p[i];
+            }
+        };
+
+        /**
+        * Runs one stage over a batch: the span overload if the stage has one, simd::transform if it is marked
+        * with simd::lanewise, otherwise a loop of single calls.
+        */
+        template<class S, typename In, typename Out>
+        void run_batch_stage(const S &s, std::span<const In> in, std::span<Out> out) {
+            if constexpr (span_stage<S, In, Out>) {
+                std::invoke(s, in, out);
+            } else if constexpr (std::is_same_v<In, Out> and simd::vectorizable<S, In>) {
+                simd::transform<In>(in, out, s);
+            } else {
+                for (std::size_t i = 0; i < in.size(); ++i) {
+                    out[i] = call_stage(s, in[i]);
+                }
+            }
+        }
+    }
+
+    /**
+    * A Pipeline run a batch at a time: each stage goes over batch_size elements before the next stage starts,
+    * and the intermediate results live in buffers of batch_size elements that are reused from batch to batch,
+    * so they stay in cache. A stage can take the whole batch by providing an overload
+    * (std::span\<const In>, std::span\<Out>), e.g. a hand-written SIMD kernel, next to (or instead of)
+    * the one-element call; stages marked with simd::lanewise are vectorized,
+    * and the other stages are called once per element.
+    * @example
+    * auto scale = fff::overload([](float x) {return x * k;},
+    *                            [](std::span\<const float> in, std::span\<float> out) {kernel(in, out);});
+    * std::vector\<float> out = fff::batched(fff::PipelineFactory()(parse, scale, clamp))(samples);
+    * @warning a stage with only the span overload must name its element output as a member type output_type.
+    * Each output type must be default constructible, since the buffers are allocated before they are written
+    */
+    template<class ...Fs>
+    class BatchedPipeline {
+        Pipeline<Fs...> pipeline;
+        std::size_t batch;
+
+        constexpr static std::size_t size = sizeof...(Fs);
+
+        template<typename In>
+        using types = typename liated::batch_chain<In, Fs...>::types;
+
+        template<typename In, std::size_t I>
+        using type_at = std::tuple_element_t<I, types<In>>;
+
+        // the buffers between two stages: the outputs of stage 0 .. size - 2
+        template<typename In, std::size_t ...I>
+        static auto make_buffers([[maybe_unused]] std::size_t n, std::index_sequence<I...>) {
+            return std::tuple<liated::BatchBuffer<type_at<In, I + 1>>...>(liated::BatchBuffer<type_at<In, I + 1>>(n)...);
+        }
+
+        template<typename In, typename Out, class Buffers, std::size_t ...I>
+        void run(std::span<const In> in, std::span<Out> out, Buffers &buffers, std::index_sequence<I...>) const {
+            const std::size_t n = in.size();
+
+            auto source = [&]<std::size_t J>() {
+                if constexpr (J == 0) {
+                    return in;
+                } else {
+                    return std::span<const type_at<In, J>>(std::get<J - 1>(buffers).data(), n);
+                }
+            };
+            auto target = [&]<std::size_t J>() {
+                if constexpr (J == size - 1) {
+                    return out;
+                } else {
+                    return std::span<type_at<In, J + 1>>(std::get<J>(buffers).data(), n);
+                }
+            };
+
+            (liated::run_batch_stage(pipeline.template stage<I>(),
+                                     source.template operator()<I>(), target.template operator()<I>()), ...);
+        }
+
+    public:
+        constexpr static std::size_t default_batch_size = 256;
+
+        /**
+        * What the pipeline makes from an In.
+        */
+        template<typename In>
+        using output_t = type_at<In, size>;
+
+        explicit BatchedPipeline(Pipeline<Fs...> pipeline, std::size_t batch_size = default_batch_size)
+            : pipeline(std::move(pipeline)), batch(std::max<std::size_t>(1, batch_size)) {}
+
+        auto batch_size() const noexcept -> std::size_t {
+            return batch;
+        }
+
+        /**
+        * out[i] = pipeline(in[i]) for every i, a batch at a time.
+        * @warning out must have at least in.size() elements
+        */
+        template<typename In, typename Out>
+            requires std::same_as<Out, output_t<std::remove_const_t<In>>>
+        void operator()(std::span<In> in, std::span<Out> out) const {
+            using T = std::remove_const_t<In>;
+
+            auto buffers = make_buffers<T>(std::min(batch, in.size()), std::make_index_sequence<size - 1>());
+            for (std::size_t b = 0; b < in.size(); b += batch) {
+                const std::size_t n = std::min(batch, in.size() - b);
+                run<T>(std::span<const T>(in).subspan(b, n), out.subspan(b, n), buffers,
+                       std::make_index_sequence<size>());
+            }
+        }
+
+        /**
+        * Runs the pipeline over input and gives the outputs to sink, one batch at a time
+        * as a std::span\<const Out> if sink takes one, otherwise one element at a time.
+        * A non-contiguous input is copied into a buffer a batch at a time.
+        */
+        template<std::ranges::input_range R, class Sink,
+                 typename Out = output_t<std::ranges::range_value_t<R>>>
+            requires std::invocable<Sink &, std::span<const Out>> or std::invocable<Sink &, Out &&>
+        void operator()(R &&input, Sink &&sink) const {
+            using In = std::ranges::range_value_t<R>;
+
+            liated::BatchBuffer<Out> out(batch);
+            auto buffers = make_buffers<In>(batch, std::make_index_sequence<size - 1>());
+
+            auto consume = [&](std::span<const In> in) {
+                run<In>(in, std::span<Out>(out.data(), in.size()), buffers, std::make_index_sequence<size>());
+
+                if constexpr (std::invocable<Sink &, std::span<const Out>>) {
+                    std::invoke(sink, std::span<const Out>(out.data(), in.size()));
+                } else {
+                    for (std::size_t i = 0; i < in.size(); ++i) {
+                        std::invoke(sink, std::move(out[i]));
+                    }
+                }
+            };
+
+            if constexpr (std::ranges::contiguous_range<R> and std::ranges::sized_range<R>) {
+                const std::span<const In> all(std::ranges::data(input), std::ranges::size(input));
+                for (std::size_t b = 0; b < all.size(); b += batch) {
+                    consume(all.subspan(b, std::min(batch, all.size() - b)));
+                }
+            } else if constexpr (std::is_same_v<In, bool>) {
+                liated::BatchBuffer<bool> in(batch);
+                std::size_t n = 0;
+
+                for (const bool v : input) {
+                    in[n++] = v;
+                    if (n == batch) {
+                        consume(std::span<const bool>(in.data(), n));
+                        n = 0;
+                    }
+                }
+                if (n != 0) {
+                    consume(std::span<const bool>(in.data(), n));
+                }
+            } else {
+                std::vector<In> in;
+                in.reserve(batch);
+
+                for (auto &&v : input) {
+                    in.push_back(std::forward<decltype(v)>(v));
+                    if (in.size() == batch) {
+                        consume(in);
+                        in.clear();
+                    }
+                }
+                if (not in.empty()) {
+                    consume(in);
+                }
+            }
+        }
+
+        /**
+        * Same as above, collecting the outputs into a std::vector.
+        */
+        template<std::ranges::input_range R>
+        auto operator()(R &&input) const -> std::vector<output_t<std::ranges::range_value_t<R>>> {
+            using In = std::ranges::range_value_t<R>;
+            using Out = output_t<In>;
+
+            if constexpr (std::ranges::contiguous_range<R> and std::ranges::sized_range<R>
+                          and not std::is_same_v<Out, bool>) {
+                // written in place, without the intermediate output buffer
+                std::vector<Out> out(std::ranges::size(input));
+                operator()(std::span<const In>(std::ranges::data(input), std::ranges::size(input)), std::span<Out>(out));
+                return out;
+            } else {
+                std::vector<Out> out;
+                if constexpr (std::ranges::sized_range<R>) {
+                    out.reserve(std::ranges::size(input));
+                }
+
+                operator()(std::forward<R>(input), [&out](Out &&v) {
+                    out.push_back(std::move(v));
+                });
+                return out;
+            }
+        }
+    };
+
+    struct BatchedFactory {
+        /**
+        * @param batch_size how many elements go through a stage at once; the buffers hold this many
+        */
+        template<class ...Fs>
+        auto operator()(Pipeline<Fs...> pipeline,
+                        std::size_t batch_size = BatchedPipeline<Fs...>::default_batch_size) const
+            -> BatchedPipeline<Fs...>
+        {
+            return BatchedPipeline<Fs...>(std::move(pipeline), batch_size);
+        }
+    };
+
+    /**
+    * @example fff::batched(fff::PipelineFactory()(f, g, h), 512)(input)
+    */
+    constexpr inline BatchedFactory batched;
+}
+
+#endif//UNDERSCORE_CPP_BATCH_HPP
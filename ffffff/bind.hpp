@@ -1,6 +1,7 @@
 #ifndef UNDERSCORE_CPP_BIND_HPP
 #define UNDERSCORE_CPP_BIND_HPP
 
+#include <concepts>
 #include <functional>
 
 #include "interfaces.hpp"
@@ -49,6 +50,12 @@ namespace fff {
 
     public:
         using function_type = F;
+
+        /**
+        * The bound values live in the type, so a Static_L_Bind_f of a stateless F can be made from nothing,
+        * e.g. as a stage of a StaticPipeline.
+        */
+        constexpr Static_L_Bind_f() noexcept requires std::default_initializable<F> : f() {}
     };
 
     template<auto ...vp>
@@ -106,6 +113,12 @@ namespace fff {
 
     public:
         using function_type = F;
+
+        /**
+        * The bound values live in the type, so a Static_R_Bind_f of a stateless F can be made from nothing,
+        * e.g. as a stage of a StaticPipeline.
+        */
+        constexpr Static_R_Bind_f() noexcept requires std::default_initializable<F> : f() {}
     };
 
     template<auto ...vp>
@@ -0,0 +1,114 @@
+#ifndef UNDERSCORE_CPP_CONCURRENCY_HPP
+#define UNDERSCORE_CPP_CONCURRENCY_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+/*
+* fff::StripedCounter : a counter that many threads can bump without sharing a cache line
+*/
+namespace fff {
+
+    /**
+    * The assumed size of a cache line. std::hardware_destructive_interference_size is not used
+    * because it may change between compilations with different flags, and headers must agree on layouts.
+    */
+    constexpr inline std::size_t cache_line_size = 64;
+
+    namespace liated {
+
+        /**
+        * A small number that identifies the calling thread, assigned in the order threads first ask.
+        */
+        inline auto thread_slot() noexcept -> std::size_t {
+            static std::atomic<std::size_t> next{0};
+            thread_local const std::size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+            return slot;
+        }
+
+        /**
+        * Spins for a while, then yields, for loops that wait on another thread.
+        */
+        class Backoff {
+            unsigned n = 0;
+
+        public:
+            void pause() noexcept {
+                if (++n > 64) {
+                    std::this_thread::yield();
+                }
+            }
+        };
+    }
+
+    /**
+    * A 64-bit counter split into stripes, one cache line each. A thread always adds to the same stripe
+    * (chosen by the order threads first touch any StripedCounter), so concurrent increments from different
+    * threads do not bounce a cache line between cores, and each one is a single relaxed fetch_add.
+    * Reading sums every stripe, which costs O(stripes) and is not a snapshot of one instant.
+    */
+    class StripedCounter {
+        struct alignas(cache_line_size) Stripe {
+            std::atomic<std::uint64_t> value{0};
+        };
+
+        std::size_t mask;
+        std::unique_ptr<Stripe[]> stripes;
+
+    public:
+        /**
+        * The next power of two of the hardware concurrency, at most 256.
+        */
+        static auto default_stripes() noexcept -> std::size_t {
+            const std::size_t hc = std::max<unsigned>(1, std::thread::hardware_concurrency());
+            return std::bit_ceil(std::min<std::size_t>(hc, 256));
+        }
+
+        /**
+        * @param stripe_count rounded up to a power of two
+        */
+        explicit StripedCounter(std::size_t stripe_count = default_stripes())
+            : mask(std::bit_ceil(std::max<std::size_t>(1, stripe_count)) - 1),
+              stripes(new Stripe[mask + 1]) {}
+
+        StripedCounter(const StripedCounter &) = delete;
+        StripedCounter &operator=(const StripedCounter &) = delete;
+
+        void add(std::uint64_t n = 1) noexcept {
+            stripes[liated::thread_slot() & mask].value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        StripedCounter &operator++() noexcept {
+            add(1);
+            return *this;
+        }
+
+        auto load() const noexcept -> std::uint64_t {
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i <= mask; ++i) {
+                sum += stripes[i].value.load(std::memory_order_relaxed);
+            }
+            return sum;
+        }
+
+        /**
+        * @warning increments that race with reset() may be kept or lost
+        */
+        void reset() noexcept {
+            for (std::size_t i = 0; i <= mask; ++i) {
+                stripes[i].value.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        auto stripe_count() const noexcept -> std::size_t {
+            return mask + 1;
+        }
+    };
+}
+
+#endif//UNDERSCORE_CPP_CONCURRENCY_HPP
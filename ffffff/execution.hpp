@@ -0,0 +1,161 @@
+#ifndef UNDERSCORE_CPP_EXECUTION_HPP
+#define UNDERSCORE_CPP_EXECUTION_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <type_traits>
+
+#include "executor.hpp"
+
+/*
+* fff::execution policies
+*/
+namespace fff::execution {
+
+    /**
+    * Runs the functor as a plain sequential loop. Same as calling it without a policy.
+    */
+    struct sequenced_policy {};
+
+    /**
+    * Splits the input into chunks and runs them on several threads.
+    * @member grain the number of elements per chunk, 0 lets the library choose
+    * @member executor where the chunks run, nullptr for fff::default_executor()
+    */
+    struct parallel_policy {
+        std::size_t grain = 0;
+        Executor *executor = nullptr;
+    };
+
+    /**
+    * Same as parallel_policy, and additionally allows the elements of a chunk to be processed unordered.
+    * @warning the function object must not synchronize with other invocations (no locks, no waiting)
+    */
+    struct parallel_unsequenced_policy {
+        std::size_t grain = 0;
+        Executor *executor = nullptr;
+    };
+
+    constexpr inline sequenced_policy seq;
+    constexpr inline parallel_policy par;
+    constexpr inline parallel_unsequenced_policy par_unseq;
+
+    /**
+    * Chunked-parallel mode with a fixed grain size.
+    * @example fff::Map()(fff::execution::chunked(4096), vec, func)
+    * @param grain the number of elements each task processes
+    */
+    constexpr auto chunked(std::size_t grain) noexcept -> parallel_policy {
+        return parallel_policy{grain};
+    }
+
+    /**
+    * Parallel mode on a given executor instead of the default one.
+    * @example fff::Map()(fff::execution::on(my_pool), vec, func)
+    */
+    constexpr auto on(Executor &executor, std::size_t grain = 0) noexcept -> parallel_policy {
+        return parallel_policy{grain, &executor};
+    }
+}
+
+namespace fff {
+
+    template<typename T>
+    concept parallel_execution_policy =
+        std::is_same_v<std::remove_cvref_t<T>, execution::parallel_policy>
+        or std::is_same_v<std::remove_cvref_t<T>, execution::parallel_unsequenced_policy>;
+
+    template<typename T>
+    concept execution_policy =
+        std::is_same_v<std::remove_cvref_t<T>, execution::sequenced_policy>
+        or parallel_execution_policy<T>;
+
+    namespace liated {
+
+        struct ChunkPlan {
+            std::size_t size;
+            std::size_t grain;
+            std::size_t count;
+            Executor *executor;
+        };
+
+        /**
+        * Decides how [0, n) is cut into chunks, and where they run.
+        * Without an explicit grain, every worker gets about four chunks so that uneven chunks still balance out.
+        */
+        template<parallel_execution_policy Policy>
+        inline auto plan_chunks(const Policy &policy, std::size_t n) -> ChunkPlan {
+            Executor &ex = policy.executor ? *policy.executor : default_executor();
+            const std::size_t workers = std::max<std::size_t>(1, ex.concurrency());
+            const std::size_t grain = policy.grain != 0
+                ? policy.grain
+                : std::max<std::size_t>(1, n / (workers * 4));
+
+            return ChunkPlan{n, grain, (n + grain - 1) / grain, &ex};
+        }
+
+        /**
+        * The number of jobs parallel_chunks() runs the plan on, the calling thread included.
+        */
+        inline auto thread_count(const ChunkPlan &plan) noexcept -> std::size_t {
+            return std::min(std::max<std::size_t>(1, plan.executor->concurrency()), plan.count);
+        }
+
+        /**
+        * Calls fn(begin, end, chunk_index) once for every chunk of the plan, from thread_count(plan) jobs:
+        * the calling thread and thread_count(plan) - 1 jobs spawned on the executor of the plan,
+        * each taking chunks until none is left.
+        * If fn also takes a fourth argument, it gets the index of the job in [0, thread_count(plan)).
+        * If fn throws, the remaining chunks are skipped and the first exception is rethrown after every job is done.
+        */
+        template<typename Fn>
+        void parallel_chunks(const ChunkPlan &plan, Fn &&fn) {
+            const std::size_t threads = thread_count(plan);
+
+            std::atomic<std::size_t> next{0};
+            std::atomic<bool> failed{false};
+            std::exception_ptr error;
+
+            auto work = [&](std::size_t w) {
+                for (;;) {
+                    const std::size_t c = next.fetch_add(1, std::memory_order_relaxed);
+                    if (c >= plan.count or failed.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                    try {
+                        const std::size_t b = c * plan.grain, e = std::min(plan.size, (c + 1) * plan.grain);
+                        if constexpr (std::is_invocable_v<Fn &, std::size_t, std::size_t, std::size_t, std::size_t>) {
+                            fn(b, e, c, w);
+                        } else {
+                            fn(b, e, c);
+                        }
+                    }
+                    catch (...) {
+                        if (not failed.exchange(true)) {
+                            error = std::current_exception();
+                        }
+                        return;
+                    }
+                }
+            };
+
+            {
+                TaskGroup group(*plan.executor);
+                for (std::size_t i = 1; i < threads; ++i) {
+                    group.spawn([&work, i] {work(i);});
+                }
+                work(0);
+                group.sync();
+            }
+
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+}
+
+#endif//UNDERSCORE_CPP_EXECUTION_HPP
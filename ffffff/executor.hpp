@@ -0,0 +1,617 @@
+#ifndef UNDERSCORE_CPP_EXECUTOR_HPP
+#define UNDERSCORE_CPP_EXECUTOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "concurrency.hpp"
+#include "function.hpp"
+
+/*
+* fff::Executor, the interface the parallel functors run on
+*/
+namespace fff {
+
+    /**
+    * Somewhere to run jobs. The parallel functors (Map, Filter, reduce... with a parallel policy) and
+    * TaskGroup only need this interface, so an application can hand them its own thread pool
+    * through set_default_executor() or the executor member of a parallel policy.
+    */
+    class Executor {
+    public:
+        virtual ~Executor() = default;
+
+        /**
+        * How many jobs can run at the same time. The parallel functors cut their input for this many threads.
+        */
+        virtual auto concurrency() const noexcept -> std::size_t = 0;
+
+        /**
+        * Runs job once, later, on some thread.
+        * @warning job must not throw; TaskGroup::spawn wraps the job to catch its exceptions
+        */
+        virtual void execute(unique_function<void()> job) = 0;
+
+        /**
+        * Called in a loop by a thread that waits for jobs (TaskGroup::sync): runs one pending job
+        * and returns true, or returns false if there is none to take.
+        * The default never helps, which is enough for threads outside the executor; an executor
+        * whose jobs spawn and sync nested jobs must help, or its workers could all end up waiting.
+        */
+        virtual bool try_run_one() {
+            return false;
+        }
+    };
+}
+
+/*
+* Chase-Lev work-stealing deque
+*/
+namespace fff::liated {
+
+    /**
+    * A growable deque of pointers that one thread (the owner) pushes and pops at the bottom,
+    * while any other thread may steal from the top. Push and pop only touch the owner's end
+    * and need no atomic read-modify-write unless the deque is down to one element.
+    * Follows "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al., PPoPP 2013).
+    * @tparam T a pointer type; nullptr means empty
+    */
+    template<typename T>
+    class ChaseLevDeque {
+        struct Array {
+            std::int64_t mask;
+            std::unique_ptr<std::atomic<T>[]> slots;
+
+            explicit Array(std::int64_t capacity) : mask(capacity - 1), slots(new std::atomic<T>[capacity]) {}
+
+            auto get(std::int64_t i) const noexcept -> T {
+                return slots[i & mask].load(std::memory_order_relaxed);
+            }
+
+            void put(std::int64_t i, T v) noexcept {
+                slots[i & mask].store(v, std::memory_order_relaxed);
+            }
+        };
+
+        alignas(cache_line_size) std::atomic<std::int64_t> top{0};
+        alignas(cache_line_size) std::atomic<std::int64_t> bottom{0};
+        std::atomic<Array *> array;
+
+        // arrays outgrown by push; a thief may still be reading one, so they live as long as the deque
+        std::vector<std::unique_ptr<Array>> arrays;
+
+    public:
+        explicit ChaseLevDeque(std::int64_t capacity = 256) {
+            arrays.push_back(std::make_unique<Array>(capacity));
+            array.store(arrays.back().get(), std::memory_order_relaxed);
+        }
+
+        ChaseLevDeque(const ChaseLevDeque &) = delete;
+        ChaseLevDeque &operator=(const ChaseLevDeque &) = delete;
+
+        /**
+        * Owner only.
+        */
+        void push(T v) {
+            const std::int64_t b = bottom.load(std::memory_order_relaxed);
+            const std::int64_t t = top.load(std::memory_order_acquire);
+            Array *a = array.load(std::memory_order_relaxed);
+
+            if (b - t > a->mask) {
+                auto bigger = std::make_unique<Array>(2 * (a->mask + 1));
+                for (std::int64_t i = t; i < b; ++i) {
+                    bigger->put(i, a->get(i));
+                }
+                a = bigger.get();
+                arrays.push_back(std::move(bigger));
+                array.store(a, std::memory_order_release);
+            }
+
+            a->put(b, v);
+            bottom.store(b + 1, std::memory_order_release);
+        }
+
+        /**
+        * Owner only. The most recently pushed element, or nullptr.
+        */
+        auto pop() noexcept -> T {
+            const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+            Array *a = array.load(std::memory_order_relaxed);
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t t = top.load(std::memory_order_relaxed);
+
+            if (t > b) {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            T v = a->get(b);
+            if (t == b) {
+                // the last element: race the thieves for it
+                if (not top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    v = nullptr;
+                }
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return v;
+        }
+
+        /**
+        * Any thread. The oldest element, or nullptr if the deque is empty or another thief got there first.
+        */
+        auto steal() noexcept -> T {
+            std::int64_t t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t b = bottom.load(std::memory_order_acquire);
+
+            if (t >= b) {
+                return nullptr;
+            }
+
+            T v = array.load(std::memory_order_acquire)->get(t);
+            if (not top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return nullptr;
+            }
+            return v;
+        }
+
+        auto empty() const noexcept -> bool {
+            return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+        }
+    };
+
+    /**
+    * The CPUs of every NUMA node this process may run on, from /sys/devices/system/node.
+    * One node holding every CPU where that is not available.
+    */
+    inline auto numa_nodes() -> std::vector<std::vector<unsigned>> {
+        std::vector<std::vector<unsigned>> nodes;
+
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        const bool restricted = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+        std::error_code ec;
+        std::vector<std::filesystem::path> dirs;
+        for (const auto &entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name.size() > 4 and name.starts_with("node")
+                and std::all_of(name.begin() + 4, name.end(), [](char c) {return c >= '0' and c <= '9';})) {
+                dirs.push_back(entry.path());
+            }
+        }
+        std::sort(dirs.begin(), dirs.end(), [](const auto &a, const auto &b) {
+            return std::stoul(a.filename().string().substr(4)) < std::stoul(b.filename().string().substr(4));
+        });
+
+        for (const auto &dir : dirs) {
+            // a cpulist looks like "0-3,8-11"
+            std::ifstream file(dir / "cpulist");
+            std::vector<unsigned> cpus;
+            std::string part;
+
+            while (std::getline(file, part, ',')) {
+                std::istringstream in(part);
+                unsigned lo = 0, hi = 0;
+                char dash = 0;
+                if (not (in >> lo)) {
+                    continue;
+                }
+                hi = (in >> dash >> hi) ? hi : lo;
+                for (unsigned cpu = lo; cpu <= hi; ++cpu) {
+                    if (not restricted or CPU_ISSET(cpu, &allowed)) {
+                        cpus.push_back(cpu);
+                    }
+                }
+            }
+            if (not cpus.empty()) {
+                nodes.push_back(std::move(cpus));
+            }
+        }
+#endif
+
+        if (nodes.empty()) {
+            nodes.emplace_back();
+            for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+                nodes.back().push_back(cpu);
+            }
+        }
+        return nodes;
+    }
+
+    /**
+    * Binds the calling thread to one CPU. Best effort: does nothing where it is not supported or not allowed.
+    */
+    inline void pin_current_thread([[maybe_unused]] unsigned cpu) noexcept {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+    }
+}
+
+/*
+* fff::WorkStealingPool, the default executor, and fff::TaskGroup
+*/
+namespace fff {
+
+    struct pool_options {
+        /**
+        * The number of worker threads, 0 for one per hardware thread.
+        */
+        std::size_t workers = 0;
+
+        /**
+        * Binds every worker to a CPU, filling one NUMA node before the next, and makes idle workers
+        * steal from the workers of their own node first, so that stolen work stays near its data.
+        */
+        bool pin = false;
+    };
+
+    /**
+    * A work-stealing thread pool. Every worker owns a Chase-Lev deque: the jobs a worker submits go to
+    * its own deque and it runs them newest first, which keeps fork/join work in its cache, while idle workers
+    * steal the oldest (usually the biggest) jobs from the others. Jobs from threads outside the pool go through
+    * a shared queue. Idle workers spin briefly, then sleep until a job is submitted.
+    */
+    class WorkStealingPool final : public Executor {
+        struct Job {
+            unique_function<void()> fn;
+        };
+
+        struct Worker {
+            liated::ChaseLevDeque<Job *> deque;
+            std::size_t node = 0;
+            std::optional<unsigned> cpu;
+            std::uint32_t seed;
+        };
+
+        constexpr static int idle_spins = 64;
+        constexpr static std::size_t no_worker = -1;
+
+        inline static thread_local WorkStealingPool *current = nullptr;
+        inline static thread_local std::size_t current_index = no_worker;
+
+        std::vector<std::unique_ptr<Worker>> workers;
+
+        std::mutex injected_m;
+        std::deque<Job *> injected;
+        std::atomic<std::size_t> injected_size{0};
+
+        std::atomic<bool> stopping{false};
+        std::atomic<std::uint32_t> epoch{0};
+        std::atomic<std::size_t> sleepers{0};
+
+        std::vector<std::jthread> threads;
+
+        static void run(Job *job) {
+            const std::unique_ptr<Job> owned(job);
+            owned->fn();
+        }
+
+        auto take_injected() -> Job * {
+            if (injected_size.load(std::memory_order_acquire) == 0) {
+                return nullptr;
+            }
+
+            const std::lock_guard lock(injected_m);
+            if (injected.empty()) {
+                return nullptr;
+            }
+            Job *job = injected.front();
+            injected.pop_front();
+            injected_size.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+
+        /**
+        * Tries the workers of self's node first (every worker when self is not a worker), from a random one on.
+        */
+        auto steal(std::size_t self) -> Job * {
+            const std::size_t n = workers.size();
+            std::uint32_t start = 0;
+            std::size_t node = 0;
+
+            if (self != no_worker) {
+                // xorshift32
+                std::uint32_t &x = workers[self]->seed;
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                start = x;
+                node = workers[self]->node;
+            }
+
+            for (const bool near : {true, false}) {
+                for (std::size_t k = 0; k < n; ++k) {
+                    const std::size_t v = (start + k) % n;
+                    if (v == self or (self != no_worker and (workers[v]->node == node) != near)) {
+                        continue;
+                    }
+                    if (Job *job = workers[v]->deque.steal()) {
+                        return job;
+                    }
+                }
+                if (self == no_worker) {
+                    break;
+                }
+            }
+            return nullptr;
+        }
+
+        auto find_job(std::size_t self) -> Job * {
+            if (self != no_worker) {
+                if (Job *job = workers[self]->deque.pop()) {
+                    return job;
+                }
+            }
+            if (Job *job = take_injected()) {
+                return job;
+            }
+            return steal(self);
+        }
+
+        void wake_one() {
+            // pairs with the fence in work(): either the sleeper sees the new job, or this sees the sleeper
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleepers.load(std::memory_order_relaxed) > 0) {
+                epoch.fetch_add(1, std::memory_order_release);
+                epoch.notify_one();
+            }
+        }
+
+        void work(std::size_t self) {
+            current = this;
+            current_index = self;
+            if (workers[self]->cpu) {
+                liated::pin_current_thread(*workers[self]->cpu);
+            }
+
+            for (;;) {
+                Job *job = find_job(self);
+                for (int spin = 0; not job and spin < idle_spins; ++spin) {
+                    std::this_thread::yield();
+                    job = find_job(self);
+                }
+                if (job) {
+                    run(job);
+                    continue;
+                }
+
+                const std::uint32_t e = epoch.load(std::memory_order_acquire);
+                sleepers.fetch_add(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if ((job = find_job(self))) {
+                    sleepers.fetch_sub(1, std::memory_order_relaxed);
+                    run(job);
+                    continue;
+                }
+                if (stopping.load(std::memory_order_acquire)) {
+                    sleepers.fetch_sub(1, std::memory_order_relaxed);
+                    return;
+                }
+
+                epoch.wait(e, std::memory_order_acquire);
+                sleepers.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+
+    public:
+        explicit WorkStealingPool(const pool_options &opt = {}) {
+            const std::size_t n = opt.workers != 0 ? opt.workers : std::max(1u, std::thread::hardware_concurrency());
+
+            std::vector<std::pair<unsigned, std::size_t>> placement;  // (cpu, node), node by node
+            if (opt.pin) {
+                const auto nodes = liated::numa_nodes();
+                for (std::size_t node = 0; node < nodes.size(); ++node) {
+                    for (const unsigned cpu : nodes[node]) {
+                        placement.emplace_back(cpu, node);
+                    }
+                }
+            }
+
+            for (std::size_t i = 0; i < n; ++i) {
+                auto w = std::make_unique<Worker>();
+                w->seed = static_cast<std::uint32_t>(i) * 0x9E3779B9u + 1;
+                if (not placement.empty()) {
+                    std::tie(w->cpu, w->node) = placement[i % placement.size()];
+                }
+                workers.push_back(std::move(w));
+            }
+
+            threads.reserve(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                threads.emplace_back([this, i] {work(i);});
+            }
+        }
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        /**
+        * Runs the jobs still queued, then joins the workers.
+        */
+        ~WorkStealingPool() override {
+            stopping.store(true, std::memory_order_release);
+            epoch.fetch_add(1, std::memory_order_release);
+            epoch.notify_all();
+            threads.clear();
+        }
+
+        auto concurrency() const noexcept -> std::size_t override {
+            return workers.size();
+        }
+
+        /**
+        * From a worker, the job goes to the front of its own deque; from any other thread, to the shared queue.
+        */
+        void execute(unique_function<void()> job) override {
+            auto owned = std::make_unique<Job>(std::move(job));
+
+            if (current == this) {
+                workers[current_index]->deque.push(owned.get());
+            } else {
+                const std::lock_guard lock(injected_m);
+                injected.push_back(owned.get());
+                injected_size.fetch_add(1, std::memory_order_release);
+            }
+            owned.release();
+
+            wake_one();
+        }
+
+        bool try_run_one() override {
+            Job *job = find_job(current == this ? current_index : no_worker);
+            if (not job) {
+                return false;
+            }
+            run(job);
+            return true;
+        }
+
+        /**
+        * The index of the calling thread among the workers of this pool, or nullopt for any other thread.
+        */
+        auto worker_index() const noexcept -> std::optional<std::size_t> {
+            if (current == this) {
+                return current_index;
+            }
+            return std::nullopt;
+        }
+    };
+
+    namespace liated {
+        inline std::atomic<Executor *> installed_executor{nullptr};
+    }
+
+    /**
+    * The pool the library makes for itself: one worker per hardware thread, started on first use.
+    */
+    inline auto builtin_executor() -> WorkStealingPool & {
+        static WorkStealingPool pool;
+        return pool;
+    }
+
+    /**
+    * What the parallel functors run on when their policy does not name an executor:
+    * the one given to set_default_executor(), or builtin_executor().
+    */
+    inline auto default_executor() -> Executor & {
+        if (Executor *ex = liated::installed_executor.load(std::memory_order_acquire)) {
+            return *ex;
+        }
+        return builtin_executor();
+    }
+
+    /**
+    * Makes ex the default executor, or restores builtin_executor() for nullptr.
+    * @return the executor installed before
+    * @warning ex must outlive its use; do not reset it while parallel functors may still be running on it
+    */
+    inline auto set_default_executor(Executor *ex) noexcept -> Executor * {
+        return liated::installed_executor.exchange(ex, std::memory_order_acq_rel);
+    }
+
+    /**
+    * Fork/join on an executor: spawn() forks jobs, sync() waits for all of them and rethrows the first
+    * exception one threw. After a job throws, the jobs that have not started yet are skipped.
+    * A thread waiting in sync() runs pending jobs meanwhile, so nested fork/join inside jobs does not deadlock
+    * on an executor that helps (WorkStealingPool does).
+    * @example
+    * fff::TaskGroup group;
+    * group.spawn([&] {left = sum(first, mid);});
+    * right = sum(mid, last);
+    * group.sync();
+    */
+    class TaskGroup {
+        Executor &ex;
+        std::atomic<std::size_t> pending{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+
+        void wait() noexcept {
+            liated::Backoff backoff;
+            while (pending.load(std::memory_order_acquire) != 0) {
+                if (not ex.try_run_one()) {
+                    backoff.pause();
+                }
+            }
+        }
+
+    public:
+        explicit TaskGroup(Executor &ex = default_executor()) noexcept : ex(ex) {}
+
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator=(const TaskGroup &) = delete;
+
+        /**
+        * Waits for the jobs, dropping their exception if sync() was not called.
+        */
+        ~TaskGroup() {
+            wait();
+        }
+
+        template<class F>
+        void spawn(F &&f) {
+            pending.fetch_add(1, std::memory_order_relaxed);
+            try {
+                ex.execute([this, f = std::forward<F>(f)]() mutable noexcept {
+                    if (not failed.load(std::memory_order_relaxed)) {
+                        try {
+                            std::invoke(f);
+                        }
+                        catch (...) {
+                            if (not failed.exchange(true)) {
+                                error = std::current_exception();
+                            }
+                        }
+                    }
+                    pending.fetch_sub(1, std::memory_order_release);
+                });
+            }
+            catch (...) {
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                throw;
+            }
+        }
+
+        void sync() {
+            wait();
+            if (failed.load(std::memory_order_relaxed)) {
+                failed.store(false, std::memory_order_relaxed);
+                std::rethrow_exception(std::exchange(error, nullptr));
+            }
+        }
+
+        auto executor() const noexcept -> Executor & {
+            return ex;
+        }
+    };
+}
+
+#endif//UNDERSCORE_CPP_EXECUTOR_HPP
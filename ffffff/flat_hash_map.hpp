@@ -0,0 +1,217 @@
+#ifndef UNDERSCORE_CPP_FLAT_HASH_MAP_HPP
+#define UNDERSCORE_CPP_FLAT_HASH_MAP_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+* fff::FlatHashMap : the map group_by, count_by and index_by aggregate into
+*/
+namespace fff {
+
+    /**
+    * An insert-only hash map with open addressing.\n
+    * The entries are kept in a vector in the order their keys were first inserted, and iterating the map is
+    * iterating that vector. A separate table of slots, probed linearly, holds the index and the hash of each
+    * entry. Growing the map only rebuilds the slot table, and the entries are never moved for it.
+    * @tparam Hash hashes K; its result is mixed again (Fibonacci hashing), so an identity std::hash is fine
+    * @warning like std::vector, inserting may invalidate iterators and references to the entries
+    */
+    template<typename K, typename V, class Hash = std::hash<K>, class KeyEqual = std::equal_to<K>>
+    class FlatHashMap {
+        struct Slot {
+            std::size_t entry;  // 1 + index in entries, 0 if the slot is empty
+            std::size_t hash;
+        };
+
+        std::vector<std::pair<K, V>> entries;
+        std::vector<Slot> slots;
+        std::size_t shift = std::numeric_limits<std::size_t>::digits;
+        std::size_t limit = 0;  // the size past which the slots are rehashed
+        [[no_unique_address]] Hash hasher;
+        [[no_unique_address]] KeyEqual equal;
+
+        constexpr static std::size_t min_slots = 8;
+
+        constexpr auto home_of(std::size_t h) const noexcept -> std::size_t {
+            return static_cast<std::size_t>(h * 0x9e3779b97f4a7c15ULL) >> shift;
+        }
+
+        /**
+        * The slot holding key, or the empty slot where it would go.
+        */
+        template<typename Q>
+        constexpr auto probe(const Q &key, std::size_t h) const noexcept -> std::size_t {
+            const std::size_t mask = slots.size() - 1;
+            for (std::size_t i = home_of(h);; i = (i + 1) & mask) {
+                const Slot &s = slots[i];
+                if (s.entry == 0 or (s.hash == h and equal(entries[s.entry - 1].first, key))) {
+                    return i;
+                }
+            }
+        }
+
+        constexpr void rehash(std::size_t slot_count) {
+            slots.assign(slot_count, Slot{0, 0});
+            shift = std::numeric_limits<std::size_t>::digits - std::countr_zero(slot_count);
+            limit = slot_count - slot_count / 8;
+
+            const std::size_t mask = slot_count - 1;
+            for (std::size_t e = 0; e < entries.size(); ++e) {
+                const std::size_t h = hasher(entries[e].first);
+                std::size_t i = home_of(h);
+                while (slots[i].entry != 0) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = Slot{e + 1, h};
+            }
+        }
+
+        /**
+        * Slots for n entries at a load factor of at most 7/8.
+        */
+        constexpr static auto slots_for(std::size_t n) noexcept -> std::size_t {
+            return std::bit_ceil(std::max(min_slots, n + n / 7 + 1));
+        }
+
+    public:
+        using key_type = K;
+        using mapped_type = V;
+        using value_type = std::pair<K, V>;
+        using size_type = std::size_t;
+        using iterator = typename std::vector<value_type>::iterator;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+        constexpr FlatHashMap() = default;
+
+        /**
+        * @param expected_keys the number of keys to make room for, so that inserting that many does not rehash
+        */
+        constexpr explicit FlatHashMap(std::size_t expected_keys, const Hash &hash = Hash(),
+                                       const KeyEqual &key_equal = KeyEqual())
+            : hasher(hash), equal(key_equal)
+        {
+            reserve(expected_keys);
+        }
+
+        constexpr void reserve(std::size_t n) {
+            entries.reserve(n);
+            if (slots_for(n) > slots.size()) {
+                rehash(slots_for(n));
+            }
+        }
+
+        /**
+        * Inserts (key, make()) unless key is already there: make is only called for a new key.
+        * @return the entry of key, and whether it was inserted
+        */
+        template<typename Q, class Make>
+            requires std::convertible_to<std::invoke_result_t<Make &>, V>
+        constexpr auto try_emplace_with(Q &&key, Make &&make) -> std::pair<iterator, bool> {
+            const std::size_t h = hasher(key);
+            std::size_t i = 0;
+            if (not slots.empty()) {
+                i = probe(key, h);
+                if (slots[i].entry != 0) {
+                    return {entries.begin() + static_cast<std::ptrdiff_t>(slots[i].entry - 1), false};
+                }
+            }
+
+            if (entries.size() + 1 > limit) {
+                rehash(std::max(slots_for(entries.size() + 1), slots.size() * 2));
+                i = probe(key, h);
+            }
+            entries.emplace_back(std::forward<Q>(key), std::invoke(make));
+            slots[i] = Slot{entries.size(), h};
+            return {std::prev(entries.end()), true};
+        }
+
+        /**
+        * Inserts (key, V(args...)) unless key is already there.
+        * @return the entry of key, and whether it was inserted
+        */
+        template<typename Q, class ...Args>
+        constexpr auto try_emplace(Q &&key, Args &&...args) -> std::pair<iterator, bool> {
+            return try_emplace_with(std::forward<Q>(key), [&] {return V(std::forward<Args>(args)...);});
+        }
+
+        template<typename Q, typename M>
+        constexpr auto insert_or_assign(Q &&key, M &&value) -> std::pair<iterator, bool> {
+            auto res = try_emplace(std::forward<Q>(key), std::forward<M>(value));
+            if (not res.second) {
+                res.first->second = std::forward<M>(value);
+            }
+            return res;
+        }
+
+        template<typename Q>
+        constexpr auto operator[](Q &&key) -> V & {
+            return try_emplace(std::forward<Q>(key)).first->second;
+        }
+
+        constexpr auto find(const K &key) -> iterator {
+            if (entries.empty()) {
+                return end();
+            }
+            const Slot &s = slots[probe(key, hasher(key))];
+            return s.entry == 0 ? end() : entries.begin() + static_cast<std::ptrdiff_t>(s.entry - 1);
+        }
+
+        constexpr auto find(const K &key) const -> const_iterator {
+            return const_cast<FlatHashMap &>(*this).find(key);
+        }
+
+        constexpr auto contains(const K &key) const -> bool {
+            return find(key) != end();
+        }
+
+        /**
+        * @throw std::out_of_range if key is not there
+        */
+        constexpr auto at(const K &key) -> V & {
+            if (auto it = find(key); it != end()) {
+                return it->second;
+            }
+            throw std::out_of_range("fff::FlatHashMap::at : no such key");
+        }
+
+        constexpr auto at(const K &key) const -> const V & {
+            return const_cast<FlatHashMap &>(*this).at(key);
+        }
+
+        constexpr void clear() noexcept {
+            entries.clear();
+            slots.assign(slots.size(), Slot{0, 0});
+        }
+
+        constexpr auto size() const noexcept -> std::size_t {return entries.size();}
+        constexpr auto empty() const noexcept -> bool {return entries.empty();}
+
+        constexpr auto begin() noexcept -> iterator {return entries.begin();}
+        constexpr auto end() noexcept -> iterator {return entries.end();}
+        constexpr auto begin() const noexcept -> const_iterator {return entries.begin();}
+        constexpr auto end() const noexcept -> const_iterator {return entries.end();}
+
+        /**
+        * Takes the entries out, in insertion order. The map is left empty.
+        */
+        constexpr auto extract() && noexcept -> std::vector<value_type> {
+            slots.assign(slots.size(), Slot{0, 0});
+            auto out = std::move(entries);
+            entries.clear();
+            return out;
+        }
+    };
+}
+
+#endif//UNDERSCORE_CPP_FLAT_HASH_MAP_HPP
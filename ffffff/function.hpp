@@ -0,0 +1,289 @@
+#ifndef UNDERSCORE_CPP_FUNCTION_HPP
+#define UNDERSCORE_CPP_FUNCTION_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+* fff::function_ref, fff::unique_function : type erasure without std::function's allocation
+*/
+namespace fff {
+
+    namespace liated {
+
+        /**
+        * std::invoke_r, which is C++23.
+        */
+        template<class R, class F, class ...Args>
+        constexpr auto invoke_r(F &&f, Args &&...args)
+            noexcept(std::is_nothrow_invocable_r_v<R, F, Args...>) -> R
+        {
+            if constexpr (std::is_void_v<R>) {
+                std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+            } else {
+                return std::invoke(std::forward<F>(f), std::forward<Args>(args)...);
+            }
+        }
+    }
+
+    template<class Sig>
+    class function_ref;
+
+    /**
+    * A non-owning reference to any callable with the call signature R(Args...).
+    * Two pointers big, never allocates; a call is a single indirect call.
+    * @warning the referred callable must outlive the function_ref, as with std::string_view.
+    * Pass function_ref by value, as a parameter, and do not store one built from a temporary
+    */
+    template<class R, class ...Args>
+    class function_ref<R(Args...)> {
+        union Target {
+            void *obj;
+            void (*fn)();
+        };
+
+        Target target;
+        R (*call)(Target, Args &&...);
+
+    public:
+        template<class F>
+            requires (not std::is_same_v<std::remove_cvref_t<F>, function_ref>)
+                     and std::is_invocable_r_v<R, F &, Args...>
+        constexpr function_ref(F &&f) noexcept {
+            using T = std::remove_reference_t<F>;
+
+            if constexpr (std::is_function_v<std::remove_pointer_t<T>> and std::is_pointer_v<T>) {
+                target.fn = reinterpret_cast<void (*)()>(f);
+                call = [](Target t, Args &&...args) -> R {
+                    return liated::invoke_r<R>(reinterpret_cast<T>(t.fn), std::forward<Args>(args)...);
+                };
+            } else if constexpr (std::is_function_v<T>) {
+                target.fn = reinterpret_cast<void (*)()>(&f);
+                call = [](Target t, Args &&...args) -> R {
+                    return liated::invoke_r<R>(reinterpret_cast<T *>(t.fn), std::forward<Args>(args)...);
+                };
+            } else {
+                target.obj = const_cast<void *>(static_cast<const volatile void *>(std::addressof(f)));
+                call = [](Target t, Args &&...args) -> R {
+                    return liated::invoke_r<R>(*static_cast<T *>(t.obj), std::forward<Args>(args)...);
+                };
+            }
+        }
+
+        constexpr function_ref(const function_ref &) noexcept = default;
+        constexpr function_ref &operator=(const function_ref &) noexcept = default;
+
+        constexpr auto operator()(Args ...args) const -> R {
+            return call(target, std::forward<Args>(args)...);
+        }
+    };
+
+    namespace liated {
+
+        /**
+        * What unique_function needs to know besides how to call: how to move and destroy the target.
+        */
+        struct UniqueFunctionOps {
+            void (*move)(void *dst, void *src) noexcept;
+            void (*destroy)(void *obj) noexcept;
+        };
+
+        template<class F, std::size_t InlineSize>
+        constexpr inline bool fits_buffer = sizeof(F) <= InlineSize
+            and alignof(F) <= alignof(std::max_align_t)
+            and std::is_nothrow_move_constructible_v<F>;
+
+        template<class F, bool Inline>
+        struct UniqueFunctionStorage;
+
+        template<class F>
+        struct UniqueFunctionStorage<F, true> {
+            static auto get(void *buf) noexcept -> F & {
+                return *std::launder(static_cast<F *>(buf));
+            }
+
+            template<class G>
+            static void create(void *buf, G &&g) {
+                ::new (buf) F(std::forward<G>(g));
+            }
+
+            constexpr static UniqueFunctionOps ops {
+                [](void *dst, void *src) noexcept {
+                    ::new (dst) F(std::move(get(src)));
+                    get(src).~F();
+                },
+                [](void *obj) noexcept {
+                    get(obj).~F();
+                },
+            };
+        };
+
+        template<class F>
+        struct UniqueFunctionStorage<F, false> {
+            static auto get(void *buf) noexcept -> F & {
+                return **static_cast<F **>(buf);
+            }
+
+            template<class G>
+            static void create(void *buf, G &&g) {
+                *static_cast<F **>(buf) = new F(std::forward<G>(g));
+            }
+
+            constexpr static UniqueFunctionOps ops {
+                [](void *dst, void *src) noexcept {
+                    *static_cast<F **>(dst) = *static_cast<F **>(src);
+                },
+                [](void *obj) noexcept {
+                    delete *static_cast<F **>(obj);
+                },
+            };
+        };
+    }
+
+    template<class Sig, std::size_t InlineSize = 3 * sizeof(void *)>
+    class unique_function;
+
+    /**
+    * An owning, move-only callable with the call signature R(Args...), or R(Args...) const
+    * for one that can be called through a const reference.\n
+    * Callables that fit in InlineSize bytes (and are nothrow movable) are stored inline without allocating;
+    * bigger ones go to the heap. The call goes through one function pointer stored in the object itself.
+    * @tparam InlineSize the size of the inline buffer, three pointers by default
+    */
+    template<class R, class ...Args, std::size_t InlineSize>
+    class unique_function<R(Args...), InlineSize> {
+    protected:
+        static_assert(InlineSize >= sizeof(void *), "fff::unique_function : the buffer must hold at least a pointer");
+
+        alignas(std::max_align_t) std::byte buf[InlineSize];
+        R (*call)(void *, Args &&...) = nullptr;
+        const liated::UniqueFunctionOps *ops = nullptr;
+
+        template<class F, bool Const>
+        void assign(F &&f) {
+            using T = std::decay_t<F>;
+            using Storage = liated::UniqueFunctionStorage<T, liated::fits_buffer<T, InlineSize>>;
+
+            Storage::create(buf, std::forward<F>(f));
+            ops = &Storage::ops;
+            call = [](void *b, Args &&...args) -> R {
+                if constexpr (Const) {
+                    return liated::invoke_r<R>(std::as_const(Storage::get(b)), std::forward<Args>(args)...);
+                } else {
+                    return liated::invoke_r<R>(Storage::get(b), std::forward<Args>(args)...);
+                }
+            };
+        }
+
+        void steal(unique_function &other) noexcept {
+            if (other.ops) {
+                other.ops->move(buf, other.buf);
+                call = std::exchange(other.call, nullptr);
+                ops = std::exchange(other.ops, nullptr);
+            }
+        }
+
+        void reset() noexcept {
+            if (ops) {
+                ops->destroy(buf);
+                call = nullptr;
+                ops = nullptr;
+            }
+        }
+
+        struct const_tag {};
+
+        template<class F>
+        unique_function(const_tag, F &&f) {
+            assign<F, true>(std::forward<F>(f));
+        }
+
+    public:
+        /**
+        * Whether a callable of type F would be stored without allocating.
+        */
+        template<class F>
+        constexpr static bool stores_inline = liated::fits_buffer<std::decay_t<F>, InlineSize>;
+
+        unique_function() noexcept = default;
+        unique_function(std::nullptr_t) noexcept {}
+
+        template<class F>
+            requires (not std::is_base_of_v<unique_function, std::decay_t<F>>)
+                     and std::is_constructible_v<std::decay_t<F>, F>
+                     and std::is_invocable_r_v<R, std::decay_t<F> &, Args...>
+        unique_function(F &&f) {
+            assign<F, false>(std::forward<F>(f));
+        }
+
+        unique_function(unique_function &&other) noexcept {
+            steal(other);
+        }
+
+        unique_function &operator=(unique_function &&other) noexcept {
+            if (this != &other) {
+                reset();
+                steal(other);
+            }
+            return *this;
+        }
+
+        unique_function &operator=(std::nullptr_t) noexcept {
+            reset();
+            return *this;
+        }
+
+        ~unique_function() {
+            reset();
+        }
+
+        explicit operator bool() const noexcept {
+            return call != nullptr;
+        }
+
+        /**
+        * @warning calling an empty unique_function is undefined behaviour
+        */
+        auto operator()(Args ...args) -> R {
+            return call(buf, std::forward<Args>(args)...);
+        }
+    };
+
+    template<class R, class ...Args, std::size_t InlineSize>
+    class unique_function<R(Args...) const, InlineSize> : private unique_function<R(Args...), InlineSize> {
+        using Base = unique_function<R(Args...), InlineSize>;
+
+    public:
+        template<class F>
+        constexpr static bool stores_inline = Base::template stores_inline<F>;
+
+        unique_function() noexcept = default;
+        unique_function(std::nullptr_t) noexcept {}
+
+        template<class F>
+            requires (not std::is_base_of_v<unique_function, std::decay_t<F>>)
+                     and std::is_constructible_v<std::decay_t<F>, F>
+                     and std::is_invocable_r_v<R, const std::decay_t<F> &, Args...>
+        unique_function(F &&f) : Base(typename Base::const_tag(), std::forward<F>(f)) {}
+
+        unique_function(unique_function &&) noexcept = default;
+        unique_function &operator=(unique_function &&) noexcept = default;
+
+        unique_function &operator=(std::nullptr_t) noexcept {
+            Base::reset();
+            return *this;
+        }
+
+        using Base::operator bool;
+
+        auto operator()(Args ...args) const -> R {
+            return this->call(const_cast<std::byte *>(this->buf), std::forward<Args>(args)...);
+        }
+    };
+}
+
+#endif//UNDERSCORE_CPP_FUNCTION_HPP
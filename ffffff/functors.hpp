@@ -3,13 +3,99 @@
 
 #include <functional>
 #include <algorithm>
+#include <cmath>
+#include <memory>
 #include <ranges>
+#include <span>
+#include <vector>
 
 #include "tmf.hpp"
 #include "basic_ops.hpp"
+#include "execution.hpp"
+#include "flat_hash_map.hpp"
+#include "memory.hpp"
+#include "pool.hpp"
+#include "simd.hpp"
+#include "soa.hpp"
+
+/*
+* fff::sizing : how Filter and PushExecution size their output
+*/
+namespace fff::sizing {
+
+    /**
+    * Lets push_back() grow the output as usual. The default.
+    */
+    struct grow_t {};
+
+    /**
+    * Reserves the input size up front.
+    * @member shrink if true, the unused capacity is given back afterwards (costs one more reallocation)
+    */
+    struct reserve_input_t {
+        bool shrink = true;
+    };
+
+    /**
+    * Counts the survivors in a first pass and reserves exactly that many. The predicate runs twice per element.
+    */
+    struct count_first_t {};
+
+    /**
+    * Reserves selectivity * (input size), for callers who know roughly which fraction survives.
+    */
+    struct hint {
+        double selectivity;
+    };
+
+    constexpr inline grow_t grow;
+    constexpr inline reserve_input_t reserve_input;
+    constexpr inline count_first_t count_first;
+}
 
 namespace fff {
 
+    template<typename T>
+    concept sizing_strategy =
+        std::is_same_v<std::remove_cvref_t<T>, sizing::grow_t>
+        or std::is_same_v<std::remove_cvref_t<T>, sizing::reserve_input_t>
+        or std::is_same_v<std::remove_cvref_t<T>, sizing::count_first_t>
+        or std::is_same_v<std::remove_cvref_t<T>, sizing::hint>;
+
+    namespace liated {
+
+        /**
+        * Reserves room in res for the survivors of cont, as the strategy says.
+        * Containers without reserve() are left alone.
+        */
+        template<class Res, class Cont, class FuncObj, sizing_strategy Strategy>
+        constexpr void reserve_for(const Strategy &strategy, Res &res, const Cont &cont, const FuncObj &func) {
+            if constexpr (reservable<Res> and std::ranges::sized_range<const Cont>) {
+                using S = std::remove_cvref_t<Strategy>;
+                const std::size_t n = std::ranges::size(cont);
+
+                if constexpr (std::is_same_v<S, sizing::reserve_input_t>) {
+                    res.reserve(res.size() + n);
+                } else if constexpr (std::is_same_v<S, sizing::count_first_t>) {
+                    const auto cnt = std::ranges::count_if(cont, std::cref(func));
+                    res.reserve(res.size() + static_cast<std::size_t>(cnt));
+                } else if constexpr (std::is_same_v<S, sizing::hint>) {
+                    const double sel = std::clamp(strategy.selectivity, 0.0, 1.0);
+                    res.reserve(res.size() + static_cast<std::size_t>(std::ceil(sel * static_cast<double>(n))));
+                }
+            }
+        }
+
+        template<class Res, sizing_strategy Strategy>
+        constexpr void shrink_after(const Strategy &strategy, Res &res) {
+            if constexpr (shrinkable<Res> and std::is_same_v<std::remove_cvref_t<Strategy>, sizing::reserve_input_t>) {
+                if (strategy.shrink) {
+                    res.shrink_to_fit();
+                }
+            }
+        }
+    }
+
     /**
     * Making Result-Container function obj.
     * @param cont any std::(container) with type T
@@ -27,22 +113,344 @@ namespace fff {
 
         template<template<class> class C, typename T, class FuncObj>
             requires std::ranges::range<C<T>>
+            and (not liated::allocator_aware<C<T>>)
+            and (not record_source<C<T>>)
             and std::invocable<FuncObj, T>
             and std::is_default_constructible_v<std::invoke_result_t<FuncObj, T>>
         constexpr auto operator()(const C<T> &cont, const FuncObj &func) const noexcept {
             return C<std::invoke_result_t<FuncObj, T>>(cont.size());
         }
+
+        /**
+        * Record sources (fff::MappedRecords...) of known size: a std::vector.
+        */
+        template<record_source Src, class FuncObj>
+            requires std::ranges::sized_range<const Src>
+            and std::invocable<FuncObj, typename Src::value_type>
+            and std::is_default_constructible_v<std::invoke_result_t<FuncObj, typename Src::value_type>>
+        constexpr auto operator()(const Src &src, const FuncObj &func) const {
+            using Res = std::vector<std::invoke_result_t<FuncObj, typename Src::value_type>>;
+            if (liated::recycling_active()) {
+                return liated::recycled_sized<Res>(std::ranges::size(src));
+            }
+            return Res(std::ranges::size(src));
+        }
+
+        /**
+        * Allocator-aware containers (std::vector, std::deque, their std::pmr versions...):
+        * the result gets the allocator of cont, rebound to U.
+        * @see liated::result_allocator
+        */
+        template<template<class, class> class C, typename T, typename A, class FuncObj>
+            requires std::ranges::range<C<T, A>>
+            and liated::allocator_aware<C<T, A>>
+            and std::invocable<FuncObj, T>
+            and std::is_default_constructible_v<std::invoke_result_t<FuncObj, T>>
+        constexpr auto operator()(const C<T, A> &cont, const FuncObj &func) const {
+            using Res = liated::rebind_container_t<C<T, A>, std::invoke_result_t<FuncObj, T>>;
+            if constexpr (liated::pool_recyclable<Res>) {
+                if (liated::recycling_active()) {
+                    return liated::recycled_sized<Res>(cont.size());
+                }
+            }
+            return Res(cont.size(), liated::result_allocator<Res>(cont));
+        }
     };
 
     struct NewCont {
         template<class Cont, class FuncObj>
             requires std::ranges::range<Cont>
             and std::is_default_constructible_v<Cont>
+            and (not record_source<Cont>)
         constexpr auto operator()(const Cont &cont, const FuncObj &funcObj) const noexcept {
-            return Cont();
+            if constexpr (liated::pool_recyclable<Cont>) {
+                return liated::recycling_active() ? pool<Cont>::acquire() : Cont();
+            } else if constexpr (liated::allocator_aware<Cont>) {
+                return Cont(liated::result_allocator<Cont>(cont));
+            } else {
+                return Cont();
+            }
+        }
+
+        /**
+        * The records of a record source are collected into a std::vector.
+        */
+        template<record_source Src, class FuncObj>
+        constexpr auto operator()(const Src &src, const FuncObj &funcObj) const {
+            using Res = std::vector<typename Src::value_type>;
+            return liated::recycling_active() ? pool<Res>::acquire() : Res();
+        }
+    };
+
+    /**
+    * Making an empty Result-Container that already has room for cont.size() elements.
+    * Unlike PreallocCont, nothing is default-constructed; the elements are emplaced later.
+    * @param cont any back-pushable, reservable std::(container) with type T
+    * @param func any function obj with 1 param, say, T -> U
+    * @return an empty std::(container) with type U
+    */
+    struct ReservedCont {
+        template<template<class> class C, typename T, class FuncObj>
+            requires std::ranges::sized_range<C<T>>
+            and (not liated::allocator_aware<C<T>>)
+            and (not record_source<C<T>>)
+            and std::invocable<FuncObj, T>
+            and backpushable<C>
+            and reservable<C<std::invoke_result_t<FuncObj, T>>>
+        constexpr auto operator()(const C<T> &cont, const FuncObj &func) const {
+            C<std::invoke_result_t<FuncObj, T>> ret;
+            ret.reserve(std::ranges::size(cont));
+            return ret;
+        }
+
+        template<template<class, class> class C, typename T, typename A, class FuncObj>
+            requires std::ranges::sized_range<C<T, A>>
+            and liated::allocator_aware<C<T, A>>
+            and std::invocable<FuncObj, T>
+            and reservable<liated::rebind_container_t<C<T, A>, std::invoke_result_t<FuncObj, T>>>
+            and requires (liated::rebind_container_t<C<T, A>, std::invoke_result_t<FuncObj, T>> &res) {
+                res.push_back(std::declval<std::invoke_result_t<FuncObj, T>>());
+            }
+        constexpr auto operator()(const C<T, A> &cont, const FuncObj &func) const {
+            using Res = liated::rebind_container_t<C<T, A>, std::invoke_result_t<FuncObj, T>>;
+            if constexpr (liated::pool_recyclable<Res>) {
+                if (liated::recycling_active()) {
+                    return liated::recycled_reserved<Res>(std::ranges::size(cont));
+                }
+            }
+            Res ret(liated::result_allocator<Res>(cont));
+            ret.reserve(std::ranges::size(cont));
+            return ret;
+        }
+
+        /**
+        * Record sources: a std::vector, with room for all of src if its size is known.
+        */
+        template<record_source Src, class FuncObj>
+            requires std::invocable<FuncObj, typename Src::value_type>
+        constexpr auto operator()(const Src &src, const FuncObj &func) const {
+            std::vector<std::invoke_result_t<FuncObj, typename Src::value_type>> ret;
+            if (liated::recycling_active()) {
+                ret = pool<decltype(ret)>::acquire();
+            }
+            if constexpr (std::ranges::sized_range<const Src>) {
+                ret.reserve(std::ranges::size(src));
+            }
+            return ret;
+        }
+    };
+
+    namespace liated {
+
+        /**
+        * The element type a functor sees when it walks over Cont: an rvalue if Cont itself is an rvalue.
+        */
+        template<class Cont>
+        using forwarded_element_t = std::conditional_t<std::is_lvalue_reference_v<Cont>,
+                                                       std::ranges::range_reference_t<Cont>,
+                                                       std::ranges::range_rvalue_reference_t<Cont>>;
+
+        template<class Cont, class It>
+        constexpr auto element_of(It &it) -> forwarded_element_t<Cont> {
+            return static_cast<forwarded_element_t<Cont>>(*it);
+        }
+
+        /**
+        * Converts to f(t) on demand. Handing this to emplace_back() makes the container construct the element
+        * right from the prvalue that f returns (guaranteed copy elision), so there is no temporary to move from.
+        */
+        template<class F, typename T>
+        struct DeferredInvoke {
+            const F &f;
+            T &&t;
+
+            constexpr operator std::invoke_result_t<const F &, T>() const && {
+                return std::invoke(f, std::forward<T>(t));
+            }
+        };
+
+        struct unrelated_argument {};
+
+        /**
+        * True if V has a constructor that takes any argument at all (std::any, std::function...).
+        * Such a constructor would take a DeferredInvoke as it is instead of converting it to f(t).
+        */
+        template<typename V>
+        concept greedy_constructible = std::is_constructible_v<V, unrelated_argument &&>;
+
+        /**
+        * True if the elements of Cont take the allocator of Cont (uses-allocator construction, e.g. std::pmr).
+        * Those are built from (value, allocator), so DeferredInvoke cannot be used for them.
+        */
+        template<class Cont>
+        concept uses_own_allocator =
+            requires {
+                typename Cont::allocator_type;
+            }
+            and std::uses_allocator_v<typename Cont::value_type, typename Cont::allocator_type>;
+    }
+
+    namespace liated {
+
+        /**
+        * Map runs func through simd::transform when the input is a contiguous range of arithmetic values,
+        * func is marked as working lane by lane (see simd::lanewise), and PreallocCont gives a contiguous result.
+        */
+        template<class Cont, class FuncObj>
+        concept simd_mappable = simd::lane_range<const Cont>
+            and simd::vectorizable<FuncObj, typename Cont::value_type>
+            and requires (const Cont &cont, const FuncObj &func) {
+                { PreallocCont()(cont, func) } -> std::ranges::contiguous_range;
+            };
+
+        /**
+        * True if PreallocCont gives a random-access result for func over cont, which chunks can write by index:
+        * it needs elements that can be default-constructed.
+        */
+        template<class Cont, class FuncObj>
+        concept parallel_preallocatable = requires (const Cont &cont, const FuncObj &func) {
+            { PreallocCont()(cont, func) } -> std::ranges::random_access_range;
+        };
+
+        /**
+        * True if the elements of Out are real objects, which chunks on different threads can write side by side.
+        * The elements of a std::vector\<bool> are bits sharing words, so two chunks writing them is a data race.
+        */
+        template<class Out>
+        concept chunk_writable = std::is_lvalue_reference_v<std::ranges::range_reference_t<Out>>;
+
+        /**
+        * out[i] = gen(i) for every i of the plan, with gen called from the chunks of the plan.
+        * If out is not chunk_writable, the chunks fill a buffer of real values, moved into out afterwards.
+        */
+        template<class Out, class Gen>
+        void parallel_generate(const ChunkPlan &plan, Out &out, const Gen &gen) {
+            if constexpr (chunk_writable<Out>) {
+                parallel_chunks(plan, [&](std::size_t b, std::size_t e, std::size_t) {
+                    auto it = std::ranges::begin(out) + b;
+                    for (; b != e; ++b, ++it) {
+                        *it = gen(b);
+                    }
+                });
+            } else {
+                const auto buf = std::make_unique_for_overwrite<std::ranges::range_value_t<Out>[]>(plan.size);
+                parallel_chunks(plan, [&](std::size_t b, std::size_t e, std::size_t) {
+                    for (; b != e; ++b) {
+                        buf[b] = gen(b);
+                    }
+                });
+
+                auto it = std::ranges::begin(out);
+                for (std::size_t i = 0; i < plan.size; ++i, ++it) {
+                    *it = std::move(buf[i]);
+                }
+            }
+        }
+    }
+
+    struct MapInto {
+        /**
+        * Writes func(x) for every x of cont through an output iterator, e.g. std::back_inserter(vec).
+        * @return the iterator past the last write
+        */
+        template<class Cont, class FuncObj, class OutIt>
+            requires std::ranges::range<Cont>
+            and (not std::ranges::range<OutIt>)
+            and std::output_iterator<std::remove_cvref_t<OutIt>,
+                                     std::invoke_result_t<const FuncObj &, liated::forwarded_element_t<Cont>>>
+        constexpr auto operator()(Cont &&cont, const FuncObj &func, OutIt &&out) const -> std::remove_cvref_t<OutIt>
+        {
+            std::remove_cvref_t<OutIt> it_u = std::forward<OutIt>(out);
+
+            for (auto it = std::ranges::begin(cont); it != std::ranges::end(cont); ++it) {
+                *it_u = std::invoke(func, liated::element_of<Cont>(it));
+                ++it_u;
+            }
+
+            return it_u;
+        }
+
+        /**
+        * Assigns func(x) over the elements of a span we already own. Writes at most dest.size() elements.
+        * @return the part of dest that was written
+        */
+        template<class Cont, class FuncObj, typename U, std::size_t E>
+            requires std::ranges::range<Cont>
+            and std::is_assignable_v<U &, std::invoke_result_t<const FuncObj &, liated::forwarded_element_t<Cont>>>
+        constexpr auto operator()(Cont &&cont, const FuncObj &func, std::span<U, E> dest) const -> std::span<U>
+        {
+            std::size_t i = 0;
+
+            for (auto it = std::ranges::begin(cont); it != std::ranges::end(cont) and i != dest.size(); ++it, ++i) {
+                dest[i] = std::invoke(func, liated::element_of<Cont>(it));
+            }
+
+            return dest.first(i);
+        }
+
+        /**
+        * Appends func(x) to a container. Every element is emplaced straight from the result of func,
+        * through the allocator of dest (custom allocators, std::pmr), with no default construction.\n
+        * Containers without emplace_back() but with contiguous storage (std::array, C arrays) are assigned over,
+        * like a span.
+        * @return dest
+        */
+        template<class Cont, class FuncObj, class Dest>
+            requires std::ranges::range<Cont>
+            and std::ranges::range<Dest>
+            and std::invocable<const FuncObj &, liated::forwarded_element_t<Cont>>
+        constexpr auto operator()(Cont &&cont, const FuncObj &func, Dest &dest) const -> Dest &
+        {
+            using T = liated::forwarded_element_t<Cont>;
+            using U = std::invoke_result_t<const FuncObj &, T>;
+
+            if constexpr (requires { dest.emplace_back(std::declval<U>()); }) {
+                if constexpr (reservable<Dest> and std::ranges::sized_range<Cont>) {
+                    dest.reserve(dest.size() + std::ranges::size(cont));
+                }
+
+                for (auto it = std::ranges::begin(cont); it != std::ranges::end(cont); ++it) {
+                    if constexpr (liated::uses_own_allocator<Dest>
+                                  or liated::greedy_constructible<std::ranges::range_value_t<Dest>>) {
+                        dest.emplace_back(std::invoke(func, liated::element_of<Cont>(it)));
+                    } else {
+                        dest.emplace_back(liated::DeferredInvoke<FuncObj, T>{func, liated::element_of<Cont>(it)});
+                    }
+                }
+            } else {
+                static_assert(std::ranges::contiguous_range<Dest>,
+                              "fff::MapInto : the destination needs emplace_back() or contiguous storage");
+                operator()(std::forward<Cont>(cont), func, std::span(dest));
+            }
+
+            return dest;
         }
     };
 
+    constexpr inline MapInto map_into;
+
+    namespace liated {
+
+        /**
+        * Adds a value at the end of a container: push_back() if it has one, otherwise insert() (std::set...).
+        * Works for any allocator or comparator the container is parametrized with.
+        */
+        struct PushPolicy {
+            template<class Cont, typename T>
+                requires requires (Cont &res_cont, T &&val) { res_cont.push_back(std::forward<T>(val)); }
+            constexpr void operator()(Cont &res_cont, T &&val) const {
+                res_cont.push_back(std::forward<T>(val));
+            }
+
+            template<class Cont, typename T>
+                requires (not requires (Cont &res_cont, T &&val) { res_cont.push_back(std::forward<T>(val)); })
+                and requires (Cont &res_cont, T &&val) { res_cont.insert(std::forward<T>(val)); }
+            constexpr void operator()(Cont &res_cont, T &&val) const {
+                res_cont.insert(std::forward<T>(val));
+            }
+        };
+    }
+
     struct MapExecution {
         /**
         * @todo consider if the return value of func is void
@@ -53,7 +461,7 @@ namespace fff {
             and std::is_same_v<typename std::invoke_result<FuncObj, typename T_cont::value_type>::type,
                                typename U_cont::value_type>
             constexpr auto &operator()(U_cont &u_cont, T_cont &t_cont, const FuncObj &func) const
-            noexcept(noexcept(func(t_cont[0])))
+            noexcept(std::is_nothrow_invocable_v<const FuncObj &, std::ranges::range_reference_t<T_cont>>)
         {
             auto it_t = t_cont.begin();
             auto it_u = u_cont.begin();
@@ -72,7 +480,7 @@ namespace fff {
             requires std::ranges::range<T_cont>
             and std::convertible_to<std::invoke_result_t<FuncObj, typename T_cont::value_type>, bool>
             constexpr auto &operator()(T_cont &res_cont, T_cont &var_cont, const FuncObj &func) const
-            noexcept(noexcept(func(var_cont[0])))
+            noexcept(std::is_nothrow_invocable_v<const FuncObj &, std::ranges::range_reference_t<T_cont>>)
         {
             for (const auto &t : var_cont) {
                 if (std::invoke(func, t)) {
@@ -83,26 +491,24 @@ namespace fff {
             return res_cont;
         }
 
-        struct PushPolicy {
-            /**
-            * If the container has push_back() method, apply it
-            */
-            template<template<class> class C, typename T>
-                requires backpushable<C>
-            constexpr void operator()(C<T> &res_cont, const T &val) const noexcept {
-                res_cont.push_back(val);
-            }
+        /**
+        * Same as above, but res_cont is sized by the strategy first.
+        * @see fff::sizing
+        */
+        template<class T_cont, class FuncObj, sizing_strategy Strategy>
+            requires std::ranges::range<T_cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename T_cont::value_type>, bool>
+            constexpr auto &operator()(T_cont &res_cont, T_cont &var_cont, const FuncObj &func,
+                                       const Strategy &strategy) const
+        {
+            liated::reserve_for(strategy, res_cont, var_cont, func);
+            operator()(res_cont, var_cont, func);
+            liated::shrink_after(strategy, res_cont);
 
-            /**
-            * If the container has no push_back() method and has insert() method,
-            * apply it
-            */
-            template<template<class> class C, typename T>
-                requires (not backpushable<C> and insertible<C>)
-            constexpr void operator()(C<T> &res_cont, const T &val) const noexcept {
-                res_cont.insert(val);
-            }
-        };
+            return res_cont;
+        }
+
+        using PushPolicy = liated::PushPolicy;
     };
 
     struct Each {
@@ -110,22 +516,78 @@ namespace fff {
             requires std::ranges::range<Cont>
             and std::invocable<FuncObj, typename Cont::value_type &>
         constexpr void operator()(Cont &cont, const FuncObj &func) const
-            noexcept(noexcept(func(cont[0])))
+            noexcept(std::is_nothrow_invocable_v<const FuncObj &, std::ranges::range_reference_t<Cont>>)
         {
             std::ranges::for_each(cont, func);
         }
+
+        /**
+        * Each with an execution policy.
+        * @warning with a parallel policy, func is called concurrently and must be thread-safe
+        */
+        template<execution_policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::invocable<FuncObj, typename Cont::value_type &>
+        constexpr void operator()(const Policy &policy, Cont &cont, const FuncObj &func) const
+        {
+            if constexpr (parallel_execution_policy<Policy> and std::ranges::random_access_range<Cont>) {
+                liated::parallel_chunks(
+                    liated::plan_chunks(policy, std::ranges::size(cont)),
+                    [&](std::size_t b, std::size_t e, std::size_t) {
+                        std::for_each(std::ranges::begin(cont) + b, std::ranges::begin(cont) + e, std::cref(func));
+                    });
+            } else {
+                operator()(cont, func);
+            }
+        }
     };
 
+    namespace liated {
+
+        /**
+        * Map, Filter of a soa_vector or a soa_selection: see below.
+        */
+        template<class Soa, class FuncObj>
+        constexpr auto soa_map(const Soa &soa, const FuncObj &func);
+
+        template<parallel_execution_policy Policy, class Soa, class FuncObj>
+        auto soa_map(const Policy &policy, const Soa &soa, const FuncObj &func);
+
+        template<class Soa, class FuncObj>
+        constexpr auto soa_filter(const Soa &soa, const FuncObj &func);
+
+        template<parallel_execution_policy Policy, class Soa, class FuncObj>
+        auto soa_filter(const Policy &policy, const Soa &soa, const FuncObj &func);
+    }
+
     struct Map {
         template<class Cont, class FuncObj>
             requires std::ranges::range<Cont>
             and std::invocable<FuncObj, typename Cont::value_type &>
         constexpr auto operator()(const Cont &cont, const FuncObj &func) const
-            noexcept(noexcept(func(cont[0])))
+            noexcept(std::is_nothrow_invocable_v<const FuncObj &, std::ranges::range_reference_t<const Cont>>)
         {
-            auto ret = PreallocCont()(cont, func);
+            using T = typename Cont::value_type;
+
+            if constexpr (soatype<Cont>) {
+                return liated::soa_map(cont, func);
+            } else if constexpr (liated::simd_mappable<Cont, FuncObj>) {
+                auto ret = PreallocCont()(cont, func);
+                if (std::is_constant_evaluated()) {
+                    std::ranges::transform(cont, std::ranges::begin(ret), std::cref(func));
+                } else {
+                    simd::transform<T>(cont, ret, func);
+                }
+
+                return ret;
+            } else if constexpr (requires { ReservedCont()(cont, func); }) {
+                auto ret = ReservedCont()(cont, func);
+                MapInto()(cont, func, ret);
+
+                return ret;
+            } else {
+                auto ret = PreallocCont()(cont, func);
 
-            {
                 auto it_t = cont.begin();
                 auto it_u = ret.begin();
 
@@ -133,9 +595,90 @@ namespace fff {
                     *it_u = std::invoke(func, *it_t);
                     ++it_t; ++it_u;
                 }
+
+                return ret;
             }
+        }
 
-            return ret;
+        /**
+        * Map over an rvalue container.
+        * If func maps T to T, the buffer of cont is transformed in place and returned,
+        * otherwise every element is moved into func.
+        */
+        template<class Cont, class FuncObj>
+            requires (not std::is_lvalue_reference_v<Cont>)
+            and std::ranges::range<Cont>
+            and std::invocable<FuncObj, typename Cont::value_type &&>
+        constexpr auto operator()(Cont &&cont, const FuncObj &func) const
+            noexcept(std::is_nothrow_invocable_v<const FuncObj &, typename Cont::value_type &&>)
+        {
+            using T = typename Cont::value_type;
+
+            if constexpr (soatype<Cont>) {
+                return liated::soa_map(cont, func);
+            } else if constexpr (std::is_same_v<std::invoke_result_t<const FuncObj &, T &&>, T>
+                          and std::is_assignable_v<std::ranges::range_reference_t<Cont>, T>) {
+                for (auto &&v : cont) {
+                    v = std::invoke(func, std::move(v));
+                }
+
+                return std::move(cont);
+            } else if constexpr (requires { ReservedCont()(cont, func); }) {
+                auto ret = ReservedCont()(cont, func);
+                MapInto()(std::move(cont), func, ret);
+
+                return ret;
+            } else {
+                auto ret = PreallocCont()(cont, func);
+
+                auto it_t = cont.begin();
+                auto it_u = ret.begin();
+
+                while (it_t != cont.end()) {
+                    *it_u = std::invoke(func, std::move(*it_t));
+                    ++it_t; ++it_u;
+                }
+
+                return ret;
+            }
+        }
+
+        /**
+        * Map with an execution policy. Each chunk writes its own slice of the preallocated result
+        * (of a buffer of real bools, for a std::vector\<bool>: see liated::parallel_generate).
+        * Falls back to the sequential loop when either side is not random-access, or when the elements of the result
+        * cannot be default-constructed, since the sequential Map does not need that.
+        */
+        template<execution_policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::invocable<FuncObj, typename Cont::value_type &>
+        constexpr auto operator()(const Policy &policy, const Cont &cont, const FuncObj &func) const
+        {
+            if constexpr (parallel_execution_policy<Policy> and soatype<Cont>) {
+                return liated::soa_map(policy, cont, func);
+            } else if constexpr (parallel_execution_policy<Policy>
+                                 and std::ranges::random_access_range<const Cont>
+                                 and liated::parallel_preallocatable<Cont, FuncObj>) {
+                auto ret = PreallocCont()(cont, func);
+                const auto plan = liated::plan_chunks(policy, std::ranges::size(cont));
+
+                if constexpr (std::is_same_v<Policy, execution::parallel_unsequenced_policy>
+                              and liated::simd_mappable<Cont, FuncObj>) {
+                    using T = typename Cont::value_type;
+                    liated::parallel_chunks(plan, [&](std::size_t b, std::size_t e, std::size_t) {
+                        simd::transform<T>(std::span<const T>(cont).subspan(b, e - b),
+                                           std::span<T>(ret).subspan(b, e - b), func);
+                    });
+                } else {
+                    liated::parallel_generate(plan, ret, [&](std::size_t i) {
+                        return std::invoke(func, std::ranges::begin(cont)[i]);
+                    });
+                }
+
+                return ret;
+            } else {
+                return operator()(cont, func);
+            }
         }
     };
 
@@ -144,39 +687,143 @@ namespace fff {
             requires std::ranges::range<Cont>
             and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type &>, bool>
             constexpr auto operator()(const Cont &cont, const FuncObj &func) const
-            noexcept(noexcept(func(cont[0])))
+            noexcept(std::is_nothrow_invocable_v<const FuncObj &, std::ranges::range_reference_t<const Cont>>)
         {
-            auto ret = NewCont()(cont, copy);
+            if constexpr (soatype<Cont>) {
+                return liated::soa_filter(cont, func);
+            } else {
+                auto ret = NewCont()(cont, copy);
+                fill(ret, cont, func, sizing::grow);
 
-            for (const auto &v : cont) {
-                if (std::invoke(func, v)) {
-                    PushPolicy()(ret, v);
-                }
+                return ret;
             }
+        }
+
+        /**
+        * Filter whose result is sized by the given strategy.
+        * @example fff::Filter()(vec, pred, fff::sizing::hint{0.1})
+        * @see fff::sizing
+        */
+        template<class Cont, class FuncObj, sizing_strategy Strategy>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type &>, bool>
+            constexpr auto operator()(const Cont &cont, const FuncObj &func, const Strategy &strategy) const
+        {
+            auto ret = NewCont()(cont, copy);
+            fill(ret, cont, func, strategy);
 
             return ret;
         }
 
-        struct PushPolicy {
-            /**
-            * If the container has push_back() method, apply it
-            */
-            template<template<class> class C, typename T>
-                requires backpushable<C>
-            constexpr void operator()(C<T> &res_cont, const T &val) const noexcept {
-                res_cont.push_back(val);
+        /**
+        * Filter into a buffer owned by the caller. out is cleared first but keeps its capacity,
+        * so a buffer reused across calls stops reallocating once it is large enough.
+        * @return out
+        */
+        template<class Cont, class FuncObj, class Out, sizing_strategy Strategy = sizing::grow_t>
+            requires std::ranges::range<Cont>
+            and std::ranges::range<Out>
+            and (not sizing_strategy<Out>)
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type &>, bool>
+            constexpr auto operator()(const Cont &cont, const FuncObj &func, Out &out,
+                                      const Strategy &strategy = Strategy()) const -> Out &
+        {
+            out.clear();
+            fill(out, cont, func, strategy);
+
+            return out;
+        }
+
+        /**
+        * Filter over an rvalue container.
+        * The rejected elements are erased from cont itself (erase-remove), nothing is copied.
+        * Containers without std::erase_if get their kept elements moved into a new container.
+        */
+        template<class Cont, class FuncObj>
+            requires (not std::is_lvalue_reference_v<Cont>)
+            and std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type &>, bool>
+            constexpr auto operator()(Cont &&cont, const FuncObj &func) const
+            noexcept(std::is_nothrow_invocable_v<const FuncObj &, typename Cont::value_type &>)
+        {
+            auto rejected = [&func](const auto &v) {
+                return not static_cast<bool>(std::invoke(func, v));
+            };
+
+            if constexpr (soatype<Cont>) {
+                return liated::soa_filter(cont, func).materialize();
+            } else if constexpr (requires { std::erase_if(cont, rejected); }) {
+                std::erase_if(cont, rejected);
+
+                return std::move(cont);
+            } else {
+                auto ret = NewCont()(cont, copy);
+
+                for (auto &&v : cont) {
+                    if (std::invoke(func, v)) {
+                        PushPolicy()(ret, std::move(v));
+                    }
+                }
+
+                return ret;
             }
+        }
 
-            /**
-            * If the container has no push_back() method and has insert() method,
-            * apply it
-            */
-            template<template<class> class C, typename T>
-                requires (not backpushable<C> and insertible<C>)
-            constexpr void operator()(C<T> &res_cont, const T &val) const noexcept {
-                res_cont.insert(val);
+        /**
+        * Filter with an execution policy.
+        * Every chunk collects its survivors into a local container, then the parts are joined in input order.
+        */
+        template<execution_policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type &>, bool>
+            constexpr auto operator()(const Policy &policy, const Cont &cont, const FuncObj &func) const
+        {
+            if constexpr (parallel_execution_policy<Policy> and soatype<Cont>) {
+                return liated::soa_filter(policy, cont, func);
+            } else if constexpr (parallel_execution_policy<Policy> and std::ranges::random_access_range<const Cont>) {
+                const auto plan = liated::plan_chunks(policy, std::ranges::size(cont));
+                std::vector<decltype(NewCont()(cont, copy))> parts(plan.count);
+
+                liated::parallel_chunks(plan, [&](std::size_t b, std::size_t e, std::size_t c) {
+                    auto it = std::ranges::begin(cont) + b;
+
+                    for (; b != e; ++b, ++it) {
+                        if (std::invoke(func, *it)) {
+                            PushPolicy()(parts[c], *it);
+                        }
+                    }
+                });
+
+                auto ret = NewCont()(cont, copy);
+                for (auto &part : parts) {
+                    for (auto &&v : part) {
+                        PushPolicy()(ret, std::move(v));
+                    }
+                }
+
+                return ret;
+            } else {
+                return operator()(cont, func);
             }
-        };
+        }
+
+    private:
+        template<class Res, class Cont, class FuncObj, sizing_strategy Strategy>
+        constexpr static void fill(Res &res, const Cont &cont, const FuncObj &func, const Strategy &strategy)
+        {
+            liated::reserve_for(strategy, res, cont, func);
+
+            for (const auto &v : cont) {
+                if (std::invoke(func, v)) {
+                    PushPolicy()(res, v);
+                }
+            }
+
+            liated::shrink_after(strategy, res);
+        }
+
+    public:
+        using PushPolicy = liated::PushPolicy;
     };
 
     struct Reject {
@@ -184,12 +831,164 @@ namespace fff {
             requires std::ranges::range<Cont>
             and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type>, bool>
             constexpr auto operator()(const Cont &cont, const FuncObj &func) const
-            noexcept(noexcept(func(cont[0])))
+            noexcept(std::is_nothrow_invocable_v<const FuncObj &, std::ranges::range_reference_t<const Cont>>)
         {
             return Filter()(cont, std::not_fn(func));
         }
+
+        template<class Cont, class FuncObj>
+            requires (not std::is_lvalue_reference_v<Cont>)
+            and std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type>, bool>
+            constexpr auto operator()(Cont &&cont, const FuncObj &func) const
+            noexcept(std::is_nothrow_invocable_v<const FuncObj &, typename Cont::value_type &>)
+        {
+            return Filter()(std::move(cont), std::not_fn(func));
+        }
+
+        template<execution_policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<FuncObj, typename Cont::value_type>, bool>
+            constexpr auto operator()(const Policy &policy, const Cont &cont, const FuncObj &func) const
+        {
+            return Filter()(policy, cont, std::not_fn(func));
+        }
     };
 
+    namespace liated {
+
+        /**
+        * The soa_vector a soa_vector or a soa_selection reads from, and the index there of its k-th row.
+        */
+        template<class Soa>
+        constexpr auto soa_source(const Soa &soa) noexcept -> const auto & {
+            if constexpr (requires { Soa::is_soa_selection; }) {
+                return soa.source();
+            } else {
+                return soa;
+            }
+        }
+
+        template<class Soa>
+        constexpr auto soa_row(const Soa &soa, std::size_t k) noexcept -> std::size_t {
+            if constexpr (requires { Soa::is_soa_selection; }) {
+                return soa.rows()[k];
+            } else {
+                return k;
+            }
+        }
+
+        /**
+        * func on row r of src: a Columns_f gets its columns straight from their storage, anything else a soa_ref.
+        */
+        template<class Src, class FuncObj>
+        constexpr decltype(auto) soa_call(const Src &src, std::size_t r, const FuncObj &func) {
+            if constexpr (column_stage<FuncObj>::value) {
+                return func.at(src, r);
+            } else {
+                return std::invoke(func, src[r]);
+            }
+        }
+
+        template<class Soa, class FuncObj>
+        using soa_map_t = std::decay_t<std::invoke_result_t<const FuncObj &, typename Soa::const_reference>>;
+
+        /**
+        * A stage of one column on a whole soa_vector, where the column is the std::vector of a field other than
+        * bool: soa_map is Map over that column.
+        */
+        template<class Soa, class FuncObj>
+        concept column_mappable = single_column_stage<FuncObj>::value and (not requires { Soa::is_soa_selection; })
+            and (not std::same_as<std::ranges::range_value_t<
+                         decltype(std::declval<const Soa &>().template column<FuncObj::first>())>, bool>);
+
+        /**
+        * A std::vector of func(row) for every row. A column_mappable stage is Map over that column,
+        * with everything Map does there (simd::transform...).
+        */
+        template<class Soa, class FuncObj>
+        constexpr auto soa_map(const Soa &soa, const FuncObj &func) {
+            if constexpr (column_mappable<Soa, FuncObj>) {
+                return Map()(soa.template column<FuncObj::first>(), func.base());
+            } else {
+                const auto &src = soa_source(soa);
+                std::vector<soa_map_t<Soa, FuncObj>> ret;
+                ret.reserve(soa.size());
+
+                for (std::size_t k = 0; k < soa.size(); ++k) {
+                    ret.push_back(soa_call(src, soa_row(soa, k), func));
+                }
+
+                return ret;
+            }
+        }
+
+        template<parallel_execution_policy Policy, class Soa, class FuncObj>
+        auto soa_map(const Policy &policy, const Soa &soa, const FuncObj &func) {
+            using R = soa_map_t<Soa, FuncObj>;
+
+            if constexpr (std::is_default_constructible_v<R> and std::is_move_assignable_v<R>) {
+                const auto &src = soa_source(soa);
+                std::vector<R> ret(soa.size());
+
+                parallel_generate(plan_chunks(policy, soa.size()), ret, [&](std::size_t r) {
+                    return soa_call(src, soa_row(soa, r), func);
+                });
+
+                return ret;
+            } else {
+                return soa_map(soa, func);
+            }
+        }
+
+        /**
+        * The rows for which func holds, as a soa_selection of the same soa_vector.
+        */
+        template<class Soa, class FuncObj>
+        constexpr auto soa_filter(const Soa &soa, const FuncObj &func) {
+            const auto &src = soa_source(soa);
+            std::vector<std::size_t> rows;
+
+            for (std::size_t k = 0; k < soa.size(); ++k) {
+                const std::size_t r = soa_row(soa, k);
+                if (soa_call(src, r, func)) {
+                    rows.push_back(r);
+                }
+            }
+
+            return soa_selection<std::remove_cvref_t<decltype(src)>>(src, std::move(rows));
+        }
+
+        template<parallel_execution_policy Policy, class Soa, class FuncObj>
+        auto soa_filter(const Policy &policy, const Soa &soa, const FuncObj &func) {
+            const auto &src = soa_source(soa);
+            const auto plan = plan_chunks(policy, soa.size());
+            std::vector<std::vector<std::size_t>> parts(plan.count);
+
+            parallel_chunks(plan, [&](std::size_t b, std::size_t e, std::size_t c) {
+                for (; b != e; ++b) {
+                    const std::size_t r = soa_row(soa, b);
+                    if (soa_call(src, r, func)) {
+                        parts[c].push_back(r);
+                    }
+                }
+            });
+
+            std::size_t n = 0;
+            for (const auto &part : parts) {
+                n += part.size();
+            }
+
+            std::vector<std::size_t> rows;
+            rows.reserve(n);
+            for (const auto &part : parts) {
+                rows.insert(rows.end(), part.begin(), part.end());
+            }
+
+            return soa_selection<std::remove_cvref_t<decltype(src)>>(src, std::move(rows));
+        }
+    }
+
     template<bool func_ret, bool ret>
     struct LogicMake {
         template<class Cont, class FuncObj>
@@ -197,15 +996,47 @@ namespace fff {
             and std::convertible_to<std::invoke_result_t
                                     <FuncObj, std::remove_cv_t<typename Cont::value_type &>>, bool>
             constexpr auto operator()(const Cont &cont, const FuncObj &func) const
-            noexcept(noexcept(func(cont[0]))) -> bool
+            noexcept(std::is_nothrow_invocable_v<const FuncObj &, std::ranges::range_reference_t<const Cont>>) -> bool
         {
-            for (auto &v : cont) {
+            for (auto &&v : cont) {
                 if (static_cast<bool>(std::invoke(func, v)) == func_ret) {
                     return ret;
                 }
             }
             return not ret;
         }
+
+        /**
+        * LogicMake with an execution policy.
+        * As soon as one worker finds the deciding element, every other worker stops at its next element.
+        */
+        template<execution_policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t
+                                    <FuncObj, std::remove_cv_t<typename Cont::value_type &>>, bool>
+            constexpr auto operator()(const Policy &policy, const Cont &cont, const FuncObj &func) const -> bool
+        {
+            if constexpr (parallel_execution_policy<Policy> and std::ranges::random_access_range<const Cont>) {
+                std::atomic<bool> decided{false};
+
+                liated::parallel_chunks(
+                    liated::plan_chunks(policy, std::ranges::size(cont)),
+                    [&](std::size_t b, std::size_t e, std::size_t) {
+                        auto it = std::ranges::begin(cont) + b;
+
+                        for (; b != e and not decided.load(std::memory_order_relaxed); ++b, ++it) {
+                            if (static_cast<bool>(std::invoke(func, *it)) == func_ret) {
+                                decided.store(true, std::memory_order_relaxed);
+                                return;
+                            }
+                        }
+                    });
+
+                return decided.load() ? ret : not ret;
+            } else {
+                return operator()(cont, func);
+            }
+        }
     };
 
     using Some = LogicMake<true, true>;
@@ -215,6 +1046,304 @@ namespace fff {
     constexpr inline Some some;
     constexpr inline Every every;
     constexpr inline None none;
+
+    namespace liated {
+
+        template<class Cont, class KeyFn>
+        using group_key_t = std::decay_t<std::invoke_result_t<const KeyFn &, const typename Cont::value_type &>>;
+
+        /**
+        * A new, empty group for the elements of cont: a Group (with the allocator of cont, if it takes one),
+        * or a container like cont if Group is void.
+        */
+        template<class Group, class Cont>
+        constexpr auto new_group(const Cont &cont) {
+            if constexpr (std::is_void_v<Group>) {
+                return NewCont()(cont, copy);
+            } else if constexpr (allocator_aware<Group>) {
+                return Group(result_allocator<Group>(cont));
+            } else {
+                return Group();
+            }
+        }
+
+        template<class Group, class Cont>
+        using group_t = decltype(new_group<Group>(std::declval<const Cont &>()));
+
+        /**
+        * True if a V can be made and filled on a worker thread: it takes no allocator, or one whose instances
+        * are all equal (std::allocator). Another allocator, e.g. a std::pmr arena, may not be safe to share between
+        * threads, and the active ScopedArena only applies on the thread that made it.
+        */
+        template<typename V>
+        concept worker_allocatable = (not allocator_aware<V>)
+            or std::allocator_traits<typename V::allocator_type>::is_always_equal::value;
+
+        /**
+        * What KeyAggregate keeps per key. A rule has value_t\<Cont>, the value of a key;
+        * make(cont, v), the value of a key first seen with v; add(value, v), for the next elements;
+        * and merge(value, other), which puts the value of a later part of the input into value.
+        */
+        template<class Group>
+        struct GroupRule {
+            template<class Cont>
+            using value_t = group_t<Group, Cont>;
+
+            template<class Cont, typename T>
+            constexpr static auto make(const Cont &cont, const T &v) {
+                auto g = new_group<Group>(cont);
+                PushPolicy()(g, v);
+                return g;
+            }
+
+            template<class G, typename T>
+            constexpr static void add(G &g, const T &v) {
+                PushPolicy()(g, v);
+            }
+
+            template<class G>
+            constexpr static void merge(G &g, G &&other) {
+                for (auto &&v : other) {
+                    PushPolicy()(g, std::move(v));
+                }
+            }
+        };
+
+        struct CountRule {
+            template<class Cont>
+            using value_t = std::size_t;
+
+            template<class Cont, typename T>
+            constexpr static auto make(const Cont &, const T &) noexcept -> std::size_t {
+                return 1;
+            }
+
+            template<typename T>
+            constexpr static void add(std::size_t &n, const T &) noexcept {
+                ++n;
+            }
+
+            constexpr static void merge(std::size_t &n, std::size_t &&other) noexcept {
+                n += other;
+            }
+        };
+
+        struct IndexRule {
+            template<class Cont>
+            using value_t = typename Cont::value_type;
+
+            template<class Cont, typename T>
+            constexpr static auto make(const Cont &, const T &v) -> typename Cont::value_type {
+                return v;
+            }
+
+            template<typename U, typename T>
+            constexpr static void add(U &u, const T &v) {
+                u = v;
+            }
+
+            template<typename U>
+            constexpr static void merge(U &u, U &&other) {
+                u = std::move(other);
+            }
+        };
+
+        /**
+        * Aggregates the elements of a container by key(element) in one pass, into a FlatHashMap.
+        * Keys are in the order they first appear in the input.
+        * @see GroupRule CountRule IndexRule
+        */
+        template<class Rule>
+        struct KeyAggregate {
+            template<class Cont, class KeyFn>
+            using result_t = FlatHashMap<group_key_t<Cont, KeyFn>, typename Rule::template value_t<Cont>>;
+
+            /**
+            * @param expected_keys the number of distinct keys to make room for up front
+            */
+            template<class Cont, class KeyFn>
+                requires std::ranges::range<Cont>
+                and std::invocable<const KeyFn &, const typename Cont::value_type &>
+            constexpr auto operator()(const Cont &cont, const KeyFn &key, std::size_t expected_keys = 0) const
+                -> result_t<Cont, KeyFn>
+            {
+                result_t<Cont, KeyFn> ret(expected_keys);
+                for (const auto &v : cont) {
+                    add(ret, cont, key, v);
+                }
+
+                return ret;
+            }
+
+            /**
+            * With a parallel policy: every chunk aggregates into a map of its own, then the maps are merged in input
+            * order, so the result is the same as the sequential one. A chunk cannot see more keys than it has
+            * elements, so its map gets room for at most that many of the expected_keys; the result gets them all.
+            * Values with an allocator that is not safe to use on worker threads (see worker_allocatable)
+            * are aggregated sequentially.
+            */
+            template<execution_policy Policy, class Cont, class KeyFn>
+                requires std::ranges::range<Cont>
+                and std::invocable<const KeyFn &, const typename Cont::value_type &>
+            constexpr auto operator()(const Policy &policy, const Cont &cont, const KeyFn &key,
+                                      std::size_t expected_keys = 0) const
+                -> result_t<Cont, KeyFn>
+            {
+                if constexpr (parallel_execution_policy<Policy> and std::ranges::random_access_range<const Cont>
+                              and worker_allocatable<typename Rule::template value_t<Cont>>) {
+                    const auto plan = liated::plan_chunks(policy, std::ranges::size(cont));
+                    std::vector<result_t<Cont, KeyFn>> parts;
+                    parts.reserve(plan.count);
+                    for (std::size_t c = 0; c < plan.count; ++c) {
+                        parts.emplace_back(std::min(expected_keys, plan.grain));
+                    }
+
+                    liated::parallel_chunks(plan, [&](std::size_t b, std::size_t e, std::size_t c) {
+                        auto it = std::ranges::begin(cont) + b;
+
+                        for (; b != e; ++b, ++it) {
+                            add(parts[c], cont, key, *it);
+                        }
+                    });
+
+                    if (parts.empty()) {
+                        return result_t<Cont, KeyFn>(expected_keys);
+                    }
+
+                    std::size_t keys = 0;
+                    for (const auto &part : parts) {
+                        keys = std::max(keys, part.size());
+                    }
+
+                    auto ret = std::move(parts.front());
+                    ret.reserve(std::max(keys, expected_keys));
+                    for (std::size_t c = 1; c < parts.size(); ++c) {
+                        for (auto &entry : std::move(parts[c]).extract()) {
+                            auto [it, inserted] = ret.try_emplace_with(std::move(entry.first), [&entry] {
+                                return std::move(entry.second);
+                            });
+                            if (not inserted) {
+                                Rule::merge(it->second, std::move(entry.second));
+                            }
+                        }
+                    }
+
+                    return ret;
+                } else {
+                    return operator()(cont, key, expected_keys);
+                }
+            }
+
+        private:
+            template<class Map, class Cont, class KeyFn, typename T>
+            constexpr static void add(Map &map, const Cont &cont, const KeyFn &key, const T &v) {
+                auto [it, inserted] = map.try_emplace_with(std::invoke(key, v), [&] {
+                    return Rule::make(cont, v);
+                });
+                if (not inserted) {
+                    Rule::add(it->second, v);
+                }
+            }
+        };
+    }
+
+    /**
+    * underscore.js's groupBy: the elements of cont by key(element), in one pass.
+    * Each group keeps the order of the input.
+    * @tparam Group the container of a group, filled with PushPolicy; void (the default) means a container like cont
+    * @return FlatHashMap from key to group, with the keys in the order they first appear
+    * @example fff::group_by(words, &std::string::size)         // FlatHashMap<std::size_t, std::vector<std::string>>
+    * @example fff::GroupBy<std::set<int>>()(nums, is_even)     // groups are std::set<int>
+    */
+    template<class Group = void>
+    using GroupBy = liated::KeyAggregate<liated::GroupRule<Group>>;
+
+    /**
+    * underscore.js's countBy: how many elements of cont have each key(element).
+    * @return FlatHashMap from key to std::size_t
+    */
+    using CountBy = liated::KeyAggregate<liated::CountRule>;
+
+    /**
+    * underscore.js's indexBy: the element of cont with each key(element). For a key shared by several, the last one.
+    * @return FlatHashMap from key to element
+    */
+    using IndexBy = liated::KeyAggregate<liated::IndexRule>;
+
+    /**
+    * underscore.js's partition: the elements of cont that satisfy func, and those that do not, in one pass.
+    * @tparam Group the container of each side, filled with PushPolicy; void (the default) means a container like cont
+    * @return std::pair of (satisfying, not satisfying), both in input order
+    */
+    template<class Group = void>
+    struct Partition {
+        template<class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<const FuncObj &, const typename Cont::value_type &>, bool>
+        constexpr auto operator()(const Cont &cont, const FuncObj &func) const {
+            auto ret = std::pair(liated::new_group<Group>(cont), liated::new_group<Group>(cont));
+            fill(ret, func, std::ranges::begin(cont), std::ranges::end(cont));
+
+            return ret;
+        }
+
+        /**
+        * Partition with an execution policy.
+        * Every chunk splits its elements into a pair of its own, then the pairs are joined in input order.
+        * Sides with an allocator that is not safe to use on worker threads (see liated::worker_allocatable),
+        * such as the std::pmr containers, are filled sequentially.
+        */
+        template<execution_policy Policy, class Cont, class FuncObj>
+            requires std::ranges::range<Cont>
+            and std::convertible_to<std::invoke_result_t<const FuncObj &, const typename Cont::value_type &>, bool>
+        constexpr auto operator()(const Policy &policy, const Cont &cont, const FuncObj &func) const {
+            if constexpr (parallel_execution_policy<Policy> and std::ranges::random_access_range<const Cont>
+                          and liated::worker_allocatable<liated::group_t<Group, Cont>>) {
+                const auto plan = liated::plan_chunks(policy, std::ranges::size(cont));
+                using Side = liated::group_t<Group, Cont>;
+                std::vector<std::pair<Side, Side>> parts;
+                parts.reserve(plan.count);
+                for (std::size_t c = 0; c < plan.count; ++c) {
+                    parts.emplace_back(liated::new_group<Group>(cont), liated::new_group<Group>(cont));
+                }
+
+                liated::parallel_chunks(plan, [&](std::size_t b, std::size_t e, std::size_t c) {
+                    const auto first = std::ranges::begin(cont);
+                    fill(parts[c], func, first + b, first + e);
+                });
+
+                auto ret = std::pair(liated::new_group<Group>(cont), liated::new_group<Group>(cont));
+                for (auto &part : parts) {
+                    liated::GroupRule<Group>::merge(ret.first, std::move(part.first));
+                    liated::GroupRule<Group>::merge(ret.second, std::move(part.second));
+                }
+
+                return ret;
+            } else {
+                return operator()(cont, func);
+            }
+        }
+
+    private:
+        template<class Res, class FuncObj, class It, class Sent>
+        constexpr static void fill(Res &res, const FuncObj &func, It it, Sent last) {
+            for (; it != last; ++it) {
+                if (std::invoke(func, *it)) {
+                    PushPolicy()(res.first, *it);
+                } else {
+                    PushPolicy()(res.second, *it);
+                }
+            }
+        }
+
+    public:
+        using PushPolicy = liated::PushPolicy;
+    };
+
+    constexpr inline GroupBy<> group_by;
+    constexpr inline CountBy count_by;
+    constexpr inline IndexBy index_by;
+    constexpr inline Partition<> partition;
 }
 
 #endif//UNDERSCORE_CPP_FUNCTORS_HPP
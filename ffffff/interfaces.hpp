@@ -28,10 +28,10 @@ namespace fff {
 
         template<typename ...Args>
         constexpr auto operator()(Args &&...args) const &
-            noexcept(noexcept(Derived::call_impl(*static_cast<Derived*>(this), std::forward<Args>(args)...)))
+            noexcept(noexcept(Derived::call_impl(*static_cast<const Derived*>(this), std::forward<Args>(args)...)))
                 -> typename TypeDeduction<F, Args...>::type
         {
-            return Derived::call_impl(*static_cast<Derived*>(this), std::forward<Args>(args)...);
+            return Derived::call_impl(*static_cast<const Derived*>(this), std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
@@ -44,10 +44,10 @@ namespace fff {
 
         template<typename ...Args>
         constexpr auto operator()(Args &&...args) const &&
-            noexcept(noexcept(Derived::call_impl(std::move(*static_cast<Derived*>(this)), std::forward<Args>(args)...)))
+            noexcept(noexcept(Derived::call_impl(std::move(*static_cast<const Derived*>(this)), std::forward<Args>(args)...)))
                 -> typename TypeDeduction<F, Args...>::type
         {
-            return Derived::call_impl(std::move(*static_cast<Derived*>(this)), std::forward<Args>(args)...);
+            return Derived::call_impl(std::move(*static_cast<const Derived*>(this)), std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
@@ -73,9 +73,9 @@ namespace fff {
 
         template<typename ...Args>
         constexpr auto operator()(Args &&...args) const &
-            noexcept(noexcept(Derived::call_impl(*static_cast<Derived*>(this), std::forward<Args>(args)...)))
+            noexcept(noexcept(Derived::call_impl(*static_cast<const Derived*>(this), std::forward<Args>(args)...)))
         {
-            return Derived::call_impl(*static_cast<Derived*>(this), std::forward<Args>(args)...);
+            return Derived::call_impl(*static_cast<const Derived*>(this), std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
@@ -87,9 +87,9 @@ namespace fff {
 
         template<typename ...Args>
         constexpr auto operator()(Args &&...args) const &&
-            noexcept(noexcept(Derived::call_impl(std::move(*static_cast<Derived*>(this)), std::forward<Args>(args)...)))
+            noexcept(noexcept(Derived::call_impl(std::move(*static_cast<const Derived*>(this)), std::forward<Args>(args)...)))
         {
-            return Derived::call_impl(std::move(*static_cast<Derived*>(this)), std::forward<Args>(args)...);
+            return Derived::call_impl(std::move(*static_cast<const Derived*>(this)), std::forward<Args>(args)...);
         }
     };
 
@@ -0,0 +1,306 @@
+#ifndef UNDERSCORE_CPP_LAZY_HPP
+#define UNDERSCORE_CPP_LAZY_HPP
+
+#include <cstddef>
+#include <functional>
+#include <ranges>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "functors.hpp"
+#include "tmf.hpp"
+
+/*
+* fff::Lazy : range pipelines fused into a single pass
+*/
+namespace fff {
+
+    template<typename T>
+    concept lazy_terminal = T::is_terminal;
+
+    namespace liated {
+
+        template<class F, class Next>
+        struct LazyMapSink {
+            const F &f;
+            Next next;
+
+            template<typename T>
+            constexpr bool push(T &&t) {
+                return next.push(std::invoke(f, std::forward<T>(t)));
+            }
+
+            constexpr auto finish() && {
+                return std::move(next).finish();
+            }
+        };
+
+        template<class F>
+        struct LazyMap {
+            constexpr static bool is_terminal = false;
+
+            [[no_unique_address]] F f;
+
+            template<typename T>
+            using output = std::invoke_result_t<const F &, T>;
+
+            template<typename T, class Next>
+            constexpr auto sink(Next &&next) const noexcept -> LazyMapSink<F, std::decay_t<Next>> {
+                return {f, std::forward<Next>(next)};
+            }
+        };
+
+        template<class F, class Next>
+        struct LazyFilterSink {
+            const F &f;
+            Next next;
+
+            template<typename T>
+            constexpr bool push(T &&t) {
+                if (std::invoke(f, std::as_const(t))) {
+                    return next.push(std::forward<T>(t));
+                }
+                return true;
+            }
+
+            constexpr auto finish() && {
+                return std::move(next).finish();
+            }
+        };
+
+        template<class F>
+        struct LazyFilter {
+            constexpr static bool is_terminal = false;
+
+            [[no_unique_address]] F f;
+
+            template<typename T>
+            using output = T;
+
+            template<typename T, class Next>
+            constexpr auto sink(Next &&next) const noexcept -> LazyFilterSink<F, std::decay_t<Next>> {
+                return {f, std::forward<Next>(next)};
+            }
+        };
+
+        template<class Next>
+        struct LazyTakeSink {
+            std::size_t remaining;
+            Next next;
+
+            template<typename T>
+            constexpr bool push(T &&t) {
+                if (remaining == 0) {
+                    return false;
+                }
+                --remaining;
+                return next.push(std::forward<T>(t)) and remaining != 0;
+            }
+
+            constexpr auto finish() && {
+                return std::move(next).finish();
+            }
+        };
+
+        struct LazyTake {
+            constexpr static bool is_terminal = false;
+
+            std::size_t n;
+
+            template<typename T>
+            using output = T;
+
+            template<typename T, class Next>
+            constexpr auto sink(Next &&next) const noexcept -> LazyTakeSink<std::decay_t<Next>> {
+                return {n, std::forward<Next>(next)};
+            }
+        };
+
+        template<class Op, typename Acc>
+        struct LazyReduceSink {
+            const Op &op;
+            Acc acc;
+
+            template<typename T>
+            constexpr bool push(T &&t) {
+                acc = std::invoke(op, std::move(acc), std::forward<T>(t));
+                return true;
+            }
+
+            constexpr auto finish() && -> Acc {
+                return std::move(acc);
+            }
+        };
+
+        template<class Op, typename Acc>
+        struct LazyReduce {
+            constexpr static bool is_terminal = true;
+
+            [[no_unique_address]] Op op;
+            Acc init;
+
+            template<typename T>
+            constexpr auto sink() const -> LazyReduceSink<Op, Acc> {
+                return {op, init};
+            }
+        };
+
+        template<class Cont>
+        struct LazyCollectSink {
+            Cont cont;
+
+            template<typename T>
+            constexpr bool push(T &&t) {
+                Filter::PushPolicy()(cont, static_cast<typename Cont::value_type>(std::forward<T>(t)));
+                return true;
+            }
+
+            constexpr auto finish() && -> Cont {
+                return std::move(cont);
+            }
+        };
+
+        template<template<class> class C>
+        struct LazyCollect {
+            constexpr static bool is_terminal = true;
+
+            template<typename T>
+            constexpr auto sink() const -> LazyCollectSink<C<std::remove_cvref_t<T>>> {
+                using Cont = C<std::remove_cvref_t<T>>;
+
+                if constexpr (allocator_aware<Cont>) {
+                    return {Cont(result_allocator<Cont>())};
+                } else {
+                    return {};
+                }
+            }
+        };
+    }
+
+    /**
+    * A pipeline over ranges. The stages do not materialize anything by themselves: when the pipeline is applied
+    * to a range, every stage is turned into a "sink" that pushes each element straight into the next one,
+    * so the whole chain runs as one loop over the input with no intermediate container.\n
+    * A sink returns false from push() when it wants no more input (take), which ends the loop early.
+    * @example (fff::lazy::map(f) | fff::lazy::filter(p) | fff::lazy::reduce(std::plus<>(), 0))(vec)
+    * @tparam Stages lazy stages; only the last one may be a terminal (reduce, to). Without a terminal,
+    * the elements are collected into a std::vector
+    */
+    template<class ...Stages>
+    class Lazy {
+        template<class ...>
+        friend class Lazy;
+
+        [[no_unique_address]] std::tuple<Stages...> stages;
+
+        constexpr static std::size_t size = sizeof...(Stages);
+        constexpr static bool has_terminal = lazy_terminal<nth_among<size - 1, Stages...>>;
+        constexpr static std::size_t pass_count = has_terminal ? size - 1 : size;
+
+        template<std::size_t I, typename T, class Term>
+        constexpr auto make_sink(const Term &term) const {
+            if constexpr (I == pass_count) {
+                return term.template sink<T>();
+            } else {
+                using Stage = nth_among<I, Stages...>;
+                return std::get<I>(stages).template sink<T>(
+                    make_sink<I + 1, typename Stage::template output<T>>(term));
+            }
+        }
+
+        template<class R, class Term>
+        constexpr auto run(R &&r, const Term &term) const {
+            auto sink = make_sink<0, std::ranges::range_reference_t<R>>(term);
+
+            for (auto &&v : r) {
+                if (not sink.push(std::forward<decltype(v)>(v))) {
+                    break;
+                }
+            }
+
+            return std::move(sink).finish();
+        }
+
+    public:
+        constexpr explicit Lazy(std::tuple<Stages...> stages) noexcept : stages(std::move(stages)) {}
+
+        static_assert((static_cast<std::size_t>(lazy_terminal<Stages>) + ... + 0) == (has_terminal ? 1 : 0),
+                      "fff::Lazy : a terminal stage must be the last one");
+
+        template<std::ranges::input_range R>
+        constexpr auto operator()(R &&r) const {
+            if constexpr (has_terminal) {
+                return run(std::forward<R>(r), std::get<size - 1>(stages));
+            } else {
+                return run(std::forward<R>(r), liated::LazyCollect<std::vector>());
+            }
+        }
+
+        template<class ...Others>
+        constexpr auto operator|(const Lazy<Others...> &other) const & -> Lazy<Stages..., Others...> {
+            static_assert(not has_terminal, "fff::Lazy : nothing can follow a terminal stage");
+            return Lazy<Stages..., Others...>{std::tuple_cat(stages, other.stages)};
+        }
+
+        template<class ...Others>
+        constexpr auto operator|(const Lazy<Others...> &other) && -> Lazy<Stages..., Others...> {
+            static_assert(not has_terminal, "fff::Lazy : nothing can follow a terminal stage");
+            return Lazy<Stages..., Others...>{std::tuple_cat(std::move(stages), other.stages)};
+        }
+    };
+
+    namespace factory {
+        struct LazyMap {
+            template<class F>
+            constexpr auto operator()(F &&f) const noexcept
+                -> Lazy<liated::LazyMap<std::decay_t<F>>>
+            {
+                return Lazy<liated::LazyMap<std::decay_t<F>>>{std::make_tuple(liated::LazyMap<std::decay_t<F>>{std::forward<F>(f)})};
+            }
+        };
+
+        struct LazyFilter {
+            template<class F>
+            constexpr auto operator()(F &&f) const noexcept
+                -> Lazy<liated::LazyFilter<std::decay_t<F>>>
+            {
+                return Lazy<liated::LazyFilter<std::decay_t<F>>>{std::make_tuple(liated::LazyFilter<std::decay_t<F>>{std::forward<F>(f)})};
+            }
+        };
+
+        struct LazyTake {
+            constexpr auto operator()(std::size_t n) const noexcept -> Lazy<liated::LazyTake> {
+                return Lazy<liated::LazyTake>{std::make_tuple(liated::LazyTake{n})};
+            }
+        };
+
+        struct LazyReduce {
+            template<class Op, typename Acc>
+            constexpr auto operator()(Op &&op, Acc &&init) const noexcept
+                -> Lazy<liated::LazyReduce<std::decay_t<Op>, std::decay_t<Acc>>>
+            {
+                return Lazy<liated::LazyReduce<std::decay_t<Op>, std::decay_t<Acc>>>
+                    {std::make_tuple(liated::LazyReduce<std::decay_t<Op>, std::decay_t<Acc>>
+                                         {std::forward<Op>(op), std::forward<Acc>(init)})};
+            }
+        };
+    }
+
+    namespace lazy {
+        constexpr inline factory::LazyMap map;
+        constexpr inline factory::LazyFilter filter;
+        constexpr inline factory::LazyTake take;
+        constexpr inline factory::LazyReduce reduce;
+
+        /**
+        * Terminal stage that collects the elements into C\<T>, using Filter::PushPolicy.
+        * std::pmr containers are allocated from the active ScopedArena, if any.
+        * @tparam C std::vector, std::deque, std::set, std::pmr::vector, ...
+        */
+        template<template<class> class C>
+        constexpr inline Lazy<liated::LazyCollect<C>> to{std::tuple<liated::LazyCollect<C>>()};
+    }
+}
+
+#endif//UNDERSCORE_CPP_LAZY_HPP
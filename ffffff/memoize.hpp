@@ -0,0 +1,279 @@
+#ifndef UNDERSCORE_CPP_MEMOIZE_HPP
+#define UNDERSCORE_CPP_MEMOIZE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "interfaces.hpp"
+#include "tmf.hpp"
+
+namespace fff::factory {
+    template<typename ...Args>
+    class Memoize;
+}
+
+/*
+* fff::memoize : a bounded, thread-safe cache in front of a pure function
+*/
+namespace fff {
+
+    /**
+    * The counters of a memoized function, summed over every shard.
+    */
+    struct MemoStats {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t evictions = 0;
+    };
+
+    namespace liated {
+
+        /**
+        * Combines std::hash of every element, boost::hash_combine style.
+        */
+        struct TupleHash {
+            template<typename ...Ts>
+            auto operator()(const std::tuple<Ts...> &t) const noexcept -> std::size_t {
+                std::size_t seed = sizeof...(Ts);
+                std::apply([&seed](const auto &...v) {
+                    ((seed ^= std::hash<std::decay_t<decltype(v)>>()(v) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)), ...);
+                }, t);
+                return seed;
+            }
+        };
+
+        /**
+        * One shard of the cache: a hash map from key to slot, and a ring of slots swept by a CLOCK hand.\n
+        * A hit takes the lock shared and only sets the slot's reference bit, so hits on the same shard
+        * run in parallel. An insertion into a full shard advances the hand, clearing reference bits,
+        * until it finds a slot not used since the last sweep, and evicts it.
+        */
+        template<typename Key, typename R>
+        class MemoShard {
+            struct Slot {
+                std::optional<std::pair<Key, R>> entry;
+                mutable std::atomic<bool> referenced{false};
+            };
+
+            mutable std::shared_mutex mtx;
+            std::unordered_map<Key, std::size_t, TupleHash> index;
+            std::vector<Slot> slots;
+            std::size_t hand = 0;
+            std::size_t used = 0;
+
+        public:
+            std::atomic<std::size_t> hits{0}, misses{0}, evictions{0};
+
+            explicit MemoShard(std::size_t capacity) : slots(capacity) {
+                index.reserve(capacity);
+            }
+
+            auto find(const Key &key) const -> std::optional<R> {
+                const std::shared_lock lock(mtx);
+
+                if (auto it = index.find(key); it != index.end()) {
+                    const Slot &slot = slots[it->second];
+                    slot.referenced.store(true, std::memory_order_relaxed);
+                    return slot.entry->second;
+                }
+                return std::nullopt;
+            }
+
+            void insert(Key &&key, const R &value) {
+                const std::unique_lock lock(mtx);
+
+                if (index.contains(key)) {
+                    return;  // another thread computed it meanwhile
+                }
+
+                std::size_t victim;
+                if (used < slots.size()) {
+                    victim = used++;
+                } else {
+                    while (slots[hand].referenced.exchange(false, std::memory_order_relaxed)) {
+                        hand = (hand + 1) % slots.size();
+                    }
+                    victim = hand;
+                    hand = (hand + 1) % slots.size();
+
+                    index.erase(slots[victim].entry->first);
+                    evictions.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                slots[victim].entry.emplace(std::move(key), value);
+                index.emplace(slots[victim].entry->first, victim);
+            }
+
+            auto size() const -> std::size_t {
+                const std::shared_lock lock(mtx);
+                return index.size();
+            }
+
+            void clear() {
+                const std::unique_lock lock(mtx);
+                index.clear();
+                for (auto &slot : slots) {
+                    slot.entry.reset();
+                    slot.referenced.store(false, std::memory_order_relaxed);
+                }
+                hand = used = 0;
+            }
+        };
+
+        template<typename Key, typename R>
+        class MemoCache {
+            std::vector<std::unique_ptr<MemoShard<Key, R>>> shards;
+
+        public:
+            MemoCache(std::size_t capacity, std::size_t shard_count) {
+                shard_count = std::max<std::size_t>(1, std::min(shard_count, capacity));
+                const std::size_t per_shard = std::max<std::size_t>(1, (capacity + shard_count - 1) / shard_count);
+
+                shards.reserve(shard_count);
+                for (std::size_t i = 0; i < shard_count; ++i) {
+                    shards.push_back(std::make_unique<MemoShard<Key, R>>(per_shard));
+                }
+            }
+
+            auto shard_of(const Key &key) -> MemoShard<Key, R> & {
+                // the top bits, so the shard does not correlate with the bucket inside the shard
+                const std::size_t h = TupleHash()(key);
+                return *shards[(h ^ (h >> (sizeof(std::size_t) * 4))) % shards.size()];
+            }
+
+            auto stats() const -> MemoStats {
+                MemoStats s;
+                for (const auto &shard : shards) {
+                    s.hits += shard->hits.load(std::memory_order_relaxed);
+                    s.misses += shard->misses.load(std::memory_order_relaxed);
+                    s.evictions += shard->evictions.load(std::memory_order_relaxed);
+                }
+                return s;
+            }
+
+            auto size() const -> std::size_t {
+                std::size_t n = 0;
+                for (const auto &shard : shards) {
+                    n += shard->size();
+                }
+                return n;
+            }
+
+            void clear() {
+                for (auto &shard : shards) {
+                    shard->clear();
+                }
+            }
+        };
+    }
+
+    /**
+    * Caches the results of f by its arguments, with a bounded number of entries.\n
+    * The cache is split into shards, each with its own lock, so threads that call with different arguments
+    * rarely meet. When a shard is full, the least recently used entries are evicted in CLOCK order.
+    * A miss runs f without holding any lock: two threads missing on the same arguments may both run f,
+    * and the first result is kept.\n
+    * Copies of a Memoize_f share the same cache.
+    * @tparam F a pure function; its result must be copyable
+    * @tparam Args the argument types the results are keyed by (decayed, hashable, equality comparable)
+    */
+    template<class F, typename ...Args>
+    class Memoize_f : public callable_i<F, Memoize_f<F, Args...>> {
+        friend callable_i<F, Memoize_f<F, Args...>>;
+        friend factory::Memoize<Args...>;
+
+        using Key = std::tuple<std::decay_t<Args>...>;
+        using R = std::decay_t<std::invoke_result_t<const F &, const std::decay_t<Args> &...>>;
+
+        [[no_unique_address]] F f;
+        std::shared_ptr<liated::MemoCache<Key, R>> cache;
+
+        Memoize_f(const F &f, std::size_t capacity, std::size_t shards)
+            : f(f), cache(std::make_shared<liated::MemoCache<Key, R>>(capacity, shards)) {}
+        Memoize_f(F &&f, std::size_t capacity, std::size_t shards)
+            : f(std::move(f)), cache(std::make_shared<liated::MemoCache<Key, R>>(capacity, shards)) {}
+
+        template<similar<Memoize_f> Self, typename ...Ts>
+            requires std::constructible_from<Key, Ts...>
+        static auto call_impl(Self &&self, Ts &&...ts) -> R
+        {
+            Key key(std::forward<Ts>(ts)...);
+            auto &shard = self.cache->shard_of(key);
+
+            if (auto hit = shard.find(key)) {
+                shard.hits.fetch_add(1, std::memory_order_relaxed);
+                return *std::move(hit);
+            }
+
+            shard.misses.fetch_add(1, std::memory_order_relaxed);
+            R r = std::apply(self.f, std::as_const(key));
+            shard.insert(std::move(key), r);
+            return r;
+        }
+
+    public:
+        auto stats() const -> MemoStats {
+            return cache->stats();
+        }
+
+        /**
+        * The number of cached entries.
+        */
+        auto size() const -> std::size_t {
+            return cache->size();
+        }
+
+        void clear() {
+            cache->clear();
+        }
+    };
+
+    namespace factory {
+        template<typename ...Args>
+        struct Memoize {
+            constexpr static std::size_t default_capacity = 1024;
+            constexpr static std::size_t default_shards = 16;
+
+            /**
+            * @param capacity the maximum number of cached results
+            * @param shards the number of independently locked parts; 1 for single-threaded use
+            */
+            template<class F>
+            auto operator()(F &&f, std::size_t capacity = default_capacity, std::size_t shards = default_shards) const
+            {
+                if constexpr (sizeof...(Args) == 0 and liated::has_signature<std::decay_t<F>>) {
+                    using Sig = typename liated::signature_args<std::decay_t<F>>::type;
+                    return [&]<typename ...Ts>(std::tuple<Ts...> *) {
+                        return Memoize<Ts...>()(std::forward<F>(f), capacity, shards);
+                    }(static_cast<Sig *>(nullptr));
+                } else {
+                    return Memoize_f<std::decay_t<F>, Args...>{std::forward<F>(f), capacity, shards};
+                }
+            }
+        };
+    }
+
+    /**
+    * @example auto slow_sqrt_m = fff::memoize(slow_sqrt, 4096); slow_sqrt_m(2.0);
+    * The argument types are deduced from f, which must then have exactly one call signature.
+    * @see memoize_as for generic lambdas and overloaded function objects
+    */
+    constexpr inline factory::Memoize<> memoize;
+
+    /**
+    * @example auto m = fff::memoize_as\<int, std::string>([](auto i, const auto &s) {...});
+    */
+    template<typename ...Args>
+    constexpr inline factory::Memoize<Args...> memoize_as;
+}
+
+#endif//UNDERSCORE_CPP_MEMOIZE_HPP
@@ -0,0 +1,164 @@
+#ifndef UNDERSCORE_CPP_MEMORY_HPP
+#define UNDERSCORE_CPP_MEMORY_HPP
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+
+/*
+* fff::ScopedArena, and how the functors choose the allocator of the containers they make
+*/
+namespace fff {
+
+    namespace liated {
+        inline thread_local std::pmr::memory_resource *scoped_resource = nullptr;
+    }
+
+    /**
+    * The memory resource new std::pmr containers made by the functors use on this thread:
+    * the innermost live ScopedArena, or std::pmr::get_default_resource() outside of any.
+    */
+    inline auto current_resource() noexcept -> std::pmr::memory_resource * {
+        return liated::scoped_resource ? liated::scoped_resource : std::pmr::get_default_resource();
+    }
+
+    /**
+    * A monotonic arena that is active on the constructing thread while it lives.
+    * Every std::pmr container a functor (Map, Filter, Reject, lazy::to...) creates in the meantime
+    * takes its memory from the arena, and all of it is released at once when the arena dies.
+    * Arenas nest; the previous one is active again after an inner one is destroyed.
+    * @example
+    * {
+    *     fff::ScopedArena arena;
+    *     std::pmr::vector\<int> in(data.begin(), data.end(), arena.resource());
+    *     auto out = fff::Map()(fff::Filter()(in, pred), f);   // intermediates and result in the arena
+    * }
+    * @warning containers with the std::allocator are not affected, since their allocator is part of the type.
+    * The arena is not synchronized: do not let worker threads allocate from it (e.g. a parallel Map whose
+    * element type is itself a pmr container), and destroy it on the thread that made it, in reverse order
+    * of construction, after every container allocated from it
+    */
+    class ScopedArena {
+        std::pmr::monotonic_buffer_resource arena;
+        std::pmr::memory_resource *previous;
+
+    public:
+        constexpr static std::size_t default_initial_size = 64 * 1024;
+
+        /**
+        * @param initial_size the size of the first block taken from upstream; later blocks grow geometrically
+        * @param upstream where the blocks come from
+        */
+        explicit ScopedArena(std::size_t initial_size = default_initial_size,
+                             std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+            : arena(initial_size, upstream), previous(liated::scoped_resource)
+        {
+            liated::scoped_resource = &arena;
+        }
+
+        /**
+        * Uses buffer first, e.g. a stack array, and goes to upstream only when it runs out.
+        */
+        ScopedArena(void *buffer, std::size_t size,
+                    std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+            : arena(buffer, size, upstream), previous(liated::scoped_resource)
+        {
+            liated::scoped_resource = &arena;
+        }
+
+        ScopedArena(const ScopedArena &) = delete;
+        ScopedArena &operator=(const ScopedArena &) = delete;
+
+        ~ScopedArena() {
+            liated::scoped_resource = previous;
+        }
+
+        auto resource() noexcept -> std::pmr::memory_resource * {
+            return &arena;
+        }
+
+        template<typename T = std::byte>
+        auto allocator() noexcept -> std::pmr::polymorphic_allocator<T> {
+            return std::pmr::polymorphic_allocator<T>(&arena);
+        }
+
+        /**
+        * Frees everything allocated so far. Only call it when no container still uses the arena.
+        */
+        void release() {
+            arena.release();
+        }
+    };
+
+    namespace liated {
+
+        template<class Cont>
+        concept allocator_aware = requires (const Cont &cont) {
+            typename Cont::allocator_type;
+            { cont.get_allocator() } -> std::same_as<typename Cont::allocator_type>;
+        };
+
+        template<class A>
+        constexpr inline bool is_polymorphic_allocator = false;
+
+        template<typename T>
+        constexpr inline bool is_polymorphic_allocator<std::pmr::polymorphic_allocator<T>> = true;
+
+        /**
+        * The allocator for a new Res that does not come from any existing container.
+        */
+        template<allocator_aware Res>
+        constexpr auto result_allocator() -> typename Res::allocator_type {
+            using A = typename Res::allocator_type;
+
+            if constexpr (is_polymorphic_allocator<A>) {
+                return A(current_resource());
+            } else {
+                return A();
+            }
+        }
+
+        /**
+        * The allocator for a new Res computed from src: the allocator of src, rebound to the element type of Res.
+        * std::pmr results use the active ScopedArena if there is one, otherwise the resource of src.
+        */
+        template<allocator_aware Res, class Src>
+        constexpr auto result_allocator(const Src &src) -> typename Res::allocator_type {
+            using A = typename Res::allocator_type;
+
+            if constexpr (is_polymorphic_allocator<A>) {
+                if (scoped_resource) {
+                    return A(scoped_resource);
+                }
+                if constexpr (allocator_aware<Src> and is_polymorphic_allocator<typename Src::allocator_type>) {
+                    return A(src.get_allocator().resource());
+                } else {
+                    return A(std::pmr::get_default_resource());
+                }
+            } else if constexpr (allocator_aware<Src>
+                                 and std::is_constructible_v<A, const typename Src::allocator_type &>) {
+                using SA = typename Src::allocator_type;
+                return A(std::allocator_traits<SA>::select_on_container_copy_construction(src.get_allocator()));
+            } else {
+                return A();
+            }
+        }
+
+        /**
+        * C\<T, A> with its element type replaced by U and its allocator rebound to U.
+        */
+        template<class Cont, typename U>
+        struct rebind_container;
+
+        template<template<class, class> class C, typename T, typename A, typename U>
+        struct rebind_container<C<T, A>, U> {
+            using type = C<U, typename std::allocator_traits<A>::template rebind_alloc<U>>;
+        };
+
+        template<class Cont, typename U>
+        using rebind_container_t = typename rebind_container<Cont, U>::type;
+    }
+}
+
+#endif//UNDERSCORE_CPP_MEMORY_HPP
@@ -1,11 +1,76 @@
 #ifndef UNDERSCORE_CPP_MONADS_HPP
 #define UNDERSCORE_CPP_MONADS_HPP
 
+#include <concepts>
+#include <cstddef>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <optional>
+#include <type_traits>
+#include <utility>
+
 #include "tmf.hpp"
 
 namespace fff {
+    template<typename T>
+    class Maybe;
+
+    template<typename T, typename E>
+    class Expected;
+
+    namespace liated {
+        /**
+        * What a stage of an Expected chain makes: the Expected it returns, or Expected\<what it returns, E>.
+        * A stage returning void has no Expected.
+        */
+        template<typename R, typename E>
+        struct expected_rewrap {
+            using type = Expected<std::remove_cvref_t<R>, E>;
+        };
+
+        template<typename R, typename E>
+            requires expectedtype<std::remove_cvref_t<R>>
+        struct expected_rewrap<R, E> {
+            using type = std::remove_cvref_t<R>;
+        };
+
+        template<typename E>
+        struct expected_rewrap<void, E> {};
+
+        template<typename R, typename E>
+        using expected_rewrap_t = typename expected_rewrap<R, E>::type;
+    }
+
+    namespace liated {
+        /**
+        * What a stage of a Maybe chain passes on: the value inside if it returned a Maybe, else what it returned.
+        */
+        template<typename R>
+        struct maybe_unwrap {
+            using type = R;
+        };
+
+        template<typename R>
+            requires maybetype<std::remove_cvref_t<R>>
+        struct maybe_unwrap<R> {
+            using type = decltype(*std::declval<R>());
+        };
+
+        template<typename V, class ...Fs>
+        struct maybe_chain_result {};
+
+        template<typename V>
+        struct maybe_chain_result<V> {
+            using type = Maybe<std::remove_cvref_t<V>>;
+        };
+
+        template<typename V, class F, class ...Fs>
+            requires std::invocable<const F &, V>
+        struct maybe_chain_result<V, F, Fs...>
+            : maybe_chain_result<typename maybe_unwrap<std::invoke_result_t<const F &, V>>::type, Fs...> {};
+    }
+
     template<typename T>
     class Maybe : public std::optional<T> {
     public:
@@ -15,19 +80,37 @@ namespace fff {
 
         /**
         * Lift : (T -> U) -> (M\<T> -> M\<U>)
+        * An rvalue Maybe moves its value into f, so a chain m >> f >> g >> h of temporaries copies no T.
+        * Use maybe_chain(f, g, h) to skip the Maybe in between as well.
         * @tparam F Function Object Type
         * @param f Function Object
         * @return f(x) if x is not empty, std::nullopt if empty
         */
         template<class F>
-            requires (std::invocable<F, T>
-                     and not std::is_void_v<std::invoke_result_t<F, T>>
-                     and not maybetype<std::invoke_result_t<F, T>>)
-        constexpr Maybe<std::invoke_result_t<F, T>> operator>>(F &&f) const
-            noexcept(noexcept(std::invoke(std::forward<F>(f), this->value())))
+            requires (std::invocable<F, const T &>
+                     and not std::is_void_v<std::invoke_result_t<F, const T &>>
+                     and not maybetype<std::remove_cvref_t<std::invoke_result_t<F, const T &>>>)
+        constexpr auto operator>>(F &&f) const &
+            noexcept(std::is_nothrow_invocable_v<F, const T &>)
+                -> Maybe<std::remove_cvref_t<std::invoke_result_t<F, const T &>>>
+        {
+            if (this->has_value()) {
+                return std::invoke(std::forward<F>(f), **this);
+            } else {
+                return std::nullopt;
+            }
+        }
+
+        template<class F>
+            requires (std::invocable<F, T &&>
+                     and not std::is_void_v<std::invoke_result_t<F, T &&>>
+                     and not maybetype<std::remove_cvref_t<std::invoke_result_t<F, T &&>>>)
+        constexpr auto operator>>(F &&f) &&
+            noexcept(std::is_nothrow_invocable_v<F, T &&>)
+                -> Maybe<std::remove_cvref_t<std::invoke_result_t<F, T &&>>>
         {
             if (this->has_value()) {
-                return std::invoke(std::forward<F>(f), this->value());
+                return std::invoke(std::forward<F>(f), std::move(**this));
             } else {
                 return std::nullopt;
             }
@@ -40,13 +123,28 @@ namespace fff {
         * @return
         */
         template<class F>
-            requires (std::invocable<F, T>
-                     and maybetype<std::invoke_result_t<F, T>>)
-        constexpr std::invoke_result_t<F, T> operator>>(F &&f) const
-            noexcept(noexcept(std::invoke(std::forward<F>(f), this->value())))
+            requires (std::invocable<F, const T &>
+                     and maybetype<std::remove_cvref_t<std::invoke_result_t<F, const T &>>>)
+        constexpr auto operator>>(F &&f) const &
+            noexcept(std::is_nothrow_invocable_v<F, const T &>)
+                -> std::remove_cvref_t<std::invoke_result_t<F, const T &>>
+        {
+            if (this->has_value()) {
+                return std::invoke(std::forward<F>(f), **this);
+            } else {
+                return std::nullopt;
+            }
+        }
+
+        template<class F>
+            requires (std::invocable<F, T &&>
+                     and maybetype<std::remove_cvref_t<std::invoke_result_t<F, T &&>>>)
+        constexpr auto operator>>(F &&f) &&
+            noexcept(std::is_nothrow_invocable_v<F, T &&>)
+                -> std::remove_cvref_t<std::invoke_result_t<F, T &&>>
         {
             if (this->has_value()) {
-                return std::invoke(std::forward<F>(f), this->value());
+                return std::invoke(std::forward<F>(f), std::move(**this));
             } else {
                 return std::nullopt;
             }
@@ -55,15 +153,77 @@ namespace fff {
         template<class F>
             requires std::invocable<F, T &>
         constexpr Maybe<T> &operator<<(F &&f)
-            noexcept(noexcept(std::invoke(std::forward<F>(f), this->value())))
+            noexcept(std::is_nothrow_invocable_v<F, T &>)
         {
             if (this->has_value()) {
-                std::invoke(std::forward<F>(f), this->value());
+                std::invoke(std::forward<F>(f), **this);
             }
             return *this;
         }
     };
 
+    /**
+    * maybe_chain(f, g, h) is the Maybe chain >> f >> g >> h fused into one function:
+    * the value goes from stage to stage without a Maybe in between, moved when a stage returns it by value,
+    * and only the stages that return a Maybe are checked for emptiness. The first empty one ends the chain.\n
+    * Called with the value, it returns the Maybe at the end; m >> chain runs it on the value inside m.
+    * @example
+    * auto validate = fff::maybe_chain(parse, check_fields, normalize);    // check_fields returns a Maybe
+    * fff::Maybe\<Request> r = validate(std::move(raw));
+    */
+    template<class ...Fs>
+    class MaybeChain {
+        static_assert(sizeof...(Fs) > 0, "fff::MaybeChain : needs at least one function");
+
+        [[no_unique_address]] liated::flat_pack<Fs...> stages;
+
+        template<typename V>
+        using result_t = typename liated::maybe_chain_result<V, Fs...>::type;
+
+        template<std::size_t I, typename R, typename V>
+        constexpr auto step(V &&v) const -> R {
+            auto &&r = std::invoke(liated::get_leaf<I>(stages), std::forward<V>(v));
+            using Out = decltype(r);
+
+            if constexpr (maybetype<std::remove_cvref_t<Out>>) {
+                if (not r.has_value()) {
+                    return R();
+                }
+                if constexpr (I + 1 == sizeof...(Fs)) {
+                    return R(std::forward<Out>(r));
+                } else {
+                    return step<I + 1, R>(*std::forward<Out>(r));
+                }
+            } else if constexpr (I + 1 == sizeof...(Fs)) {
+                return R(std::forward<Out>(r));
+            } else {
+                return step<I + 1, R>(std::forward<Out>(r));
+            }
+        }
+
+    public:
+        template<class ...Us>
+            requires (sizeof...(Us) == sizeof...(Fs))
+                and (std::constructible_from<Fs, Us> and ...)
+                and (not std::same_as<std::remove_cvref_t<Us>, MaybeChain> and ...)
+        constexpr explicit MaybeChain(Us &&...fs) noexcept
+            : stages(std::in_place, std::forward<Us>(fs)...) {}
+
+        template<typename V>
+        constexpr auto operator()(V &&v) const -> result_t<V> {
+            return step<0, result_t<V>>(std::forward<V>(v));
+        }
+    };
+
+    struct MaybeChainFactory {
+        template<class ...Fs>
+        constexpr auto operator()(Fs &&...fs) const noexcept -> MaybeChain<std::decay_t<Fs>...> {
+            return MaybeChain<std::decay_t<Fs>...>(std::forward<Fs>(fs)...);
+        }
+    };
+
+    constexpr inline MaybeChainFactory maybe_chain;
+
     struct MaybeFactory {
         template<typename T>
         constexpr auto operator()(T &&t) const noexcept
@@ -81,4 +241,358 @@ namespace fff {
     };
 }
 
+/*
+* fff::Expected
+*/
+namespace fff {
+
+    /**
+    * The error an Expected is made from: return fff::Unexpected(e) from a function that returns Expected\<T, E>.
+    */
+    template<typename E>
+    class Unexpected {
+        E err;
+
+    public:
+        template<typename G = E>
+            requires std::constructible_from<E, G> and (not std::same_as<std::remove_cvref_t<G>, Unexpected>)
+        constexpr explicit Unexpected(G &&e) noexcept(std::is_nothrow_constructible_v<E, G>)
+            : err(std::forward<G>(e)) {}
+
+        constexpr auto error() & noexcept -> E & {
+            return err;
+        }
+
+        constexpr auto error() const & noexcept -> const E & {
+            return err;
+        }
+
+        constexpr auto error() && noexcept -> E && {
+            return std::move(err);
+        }
+    };
+
+    template<typename E>
+    Unexpected(E) -> Unexpected<E>;
+
+    struct unexpect_t {
+        explicit unexpect_t() = default;
+    };
+
+    constexpr inline unexpect_t unexpect{};
+
+    /**
+    * Thrown by Expected::value() when there is an error instead.
+    */
+    template<typename E>
+    class BadExpectedAccess : public std::exception {
+        E err;
+
+    public:
+        explicit BadExpectedAccess(E e) : err(std::move(e)) {}
+
+        auto error() const noexcept -> const E & {
+            return err;
+        }
+
+        auto what() const noexcept -> const char * override {
+            return "fff::Expected : value() called on an error";
+        }
+    };
+
+    /**
+    * A T or the E that explains why there is none: the interface of C++23 std::expected (which this standard
+    * library does not have yet), with operator>> as Maybe has.\n
+    * A Pipeline passes the value of an Expected to a stage that takes T and wraps what the stage returns
+    * back into an Expected; after the first error it skips the remaining stages and hands the error on,
+    * without throwing, so a chain of fallible stages costs one has_value() branch per stage.
+    * A stage whose parameter is declared as the Expected itself gets it as it is, e.g. to recover from the error
+    * (a generic stage is handed the value).
+    * @example
+    * auto parse = [](std::string_view s) -> fff::Expected\<int, Error> {
+    *     if (s.empty()) return fff::Unexpected(Error::empty);
+    *     return to_int(s);
+    * };
+    * auto chain = fff::PipelineFactory()(parse, [](int x) {return x * 2;});   // Expected\<int, Error>
+    */
+    template<typename T, typename E>
+    class Expected {
+        static_assert(not std::is_reference_v<T> and not std::is_void_v<T>, "fff::Expected : T must be an object type");
+        static_assert(not std::is_reference_v<E> and not std::is_void_v<E>, "fff::Expected : E must be an object type");
+
+        union {
+            T val;
+            E err;
+        };
+        bool has;
+
+        constexpr static bool trivial = std::is_trivially_copyable_v<T> and std::is_trivially_copyable_v<E>;
+
+        template<typename Other>
+        constexpr void construct_from(Other &&other) {
+            if (other.has) {
+                std::construct_at(std::addressof(val), std::forward<Other>(other).val);
+            } else {
+                std::construct_at(std::addressof(err), std::forward<Other>(other).err);
+            }
+            has = other.has;
+        }
+
+        /**
+        * Replaces old_alt with new_alt(std::forward<Args>(args)...), leaving old_alt in place if that throws:
+        * the new alternative is made in a temporary first, or the old one is kept in a temporary meanwhile.
+        */
+        template<typename New, typename Old, typename ...Args>
+        constexpr static void reinit(New &new_alt, Old &old_alt, Args &&...args) {
+            if constexpr (std::is_nothrow_constructible_v<New, Args...>) {
+                std::destroy_at(std::addressof(old_alt));
+                std::construct_at(std::addressof(new_alt), std::forward<Args>(args)...);
+            } else if constexpr (std::is_nothrow_move_constructible_v<New>) {
+                New tmp(std::forward<Args>(args)...);
+                std::destroy_at(std::addressof(old_alt));
+                std::construct_at(std::addressof(new_alt), std::move(tmp));
+            } else {
+                Old tmp(std::move(old_alt));
+                std::destroy_at(std::addressof(old_alt));
+                try {
+                    std::construct_at(std::addressof(new_alt), std::forward<Args>(args)...);
+                } catch (...) {
+                    std::construct_at(std::addressof(old_alt), std::move(tmp));
+                    throw;
+                }
+            }
+        }
+
+        template<typename Other>
+        constexpr void assign_from(Other &&other) {
+            if (has and other.has) {
+                val = std::forward<Other>(other).val;
+            } else if (not has and not other.has) {
+                err = std::forward<Other>(other).err;
+            } else if (has) {
+                reinit(err, val, std::forward<Other>(other).err);
+                has = false;
+            } else {
+                reinit(val, err, std::forward<Other>(other).val);
+                has = true;
+            }
+        }
+
+        constexpr void destroy() noexcept {
+            if (has) {
+                std::destroy_at(std::addressof(val));
+            } else {
+                std::destroy_at(std::addressof(err));
+            }
+        }
+
+    public:
+        using value_type = T;
+        using error_type = E;
+
+        constexpr static bool is_expected = true;
+
+        constexpr Expected() noexcept(std::is_nothrow_default_constructible_v<T>)
+            requires std::default_initializable<T>
+            : val(), has(true) {}
+
+        template<typename U = T>
+            requires std::constructible_from<T, U>
+                and (not std::same_as<std::remove_cvref_t<U>, Expected>)
+                and (not std::same_as<std::remove_cvref_t<U>, unexpect_t>)
+                and (not std::same_as<std::remove_cvref_t<U>, std::in_place_t>)
+        constexpr explicit(not std::convertible_to<U, T>) Expected(U &&v)
+            noexcept(std::is_nothrow_constructible_v<T, U>)
+            : val(std::forward<U>(v)), has(true) {}
+
+        template<typename G>
+            requires std::constructible_from<E, const G &>
+        constexpr Expected(const Unexpected<G> &u) noexcept(std::is_nothrow_constructible_v<E, const G &>)
+            : err(u.error()), has(false) {}
+
+        template<typename G>
+            requires std::constructible_from<E, G>
+        constexpr Expected(Unexpected<G> &&u) noexcept(std::is_nothrow_constructible_v<E, G>)
+            : err(std::move(u).error()), has(false) {}
+
+        template<typename ...Args>
+            requires std::constructible_from<T, Args...>
+        constexpr explicit Expected(std::in_place_t, Args &&...args)
+            : val(std::forward<Args>(args)...), has(true) {}
+
+        template<typename ...Args>
+            requires std::constructible_from<E, Args...>
+        constexpr explicit Expected(unexpect_t, Args &&...args)
+            : err(std::forward<Args>(args)...), has(false) {}
+
+        constexpr Expected(const Expected &) requires trivial = default;
+        constexpr Expected(Expected &&) requires trivial = default;
+        constexpr auto operator=(const Expected &) -> Expected & requires trivial = default;
+        constexpr auto operator=(Expected &&) -> Expected & requires trivial = default;
+
+        constexpr Expected(const Expected &other)
+            requires std::copy_constructible<T> and std::copy_constructible<E> and (not trivial)
+        {
+            construct_from(other);
+        }
+
+        constexpr Expected(Expected &&other)
+            noexcept(std::is_nothrow_move_constructible_v<T> and std::is_nothrow_move_constructible_v<E>)
+            requires std::move_constructible<T> and std::move_constructible<E> and (not trivial)
+        {
+            construct_from(std::move(other));
+        }
+
+        /**
+        * Either the whole assignment happens, or *this keeps what it held (then as T's or E's own assignment
+        * leaves it, if both sides hold the same alternative).
+        */
+        constexpr auto operator=(const Expected &other) -> Expected &
+            requires std::copy_constructible<T> and std::copy_constructible<E> and (not trivial)
+                and std::is_copy_assignable_v<T> and std::is_copy_assignable_v<E>
+                and (std::is_nothrow_move_constructible_v<T> or std::is_nothrow_move_constructible_v<E>)
+        {
+            if (this != std::addressof(other)) {
+                assign_from(other);
+            }
+            return *this;
+        }
+
+        constexpr auto operator=(Expected &&other)
+            noexcept(std::is_nothrow_move_constructible_v<T> and std::is_nothrow_move_constructible_v<E>
+                     and std::is_nothrow_move_assignable_v<T> and std::is_nothrow_move_assignable_v<E>)
+                -> Expected &
+            requires std::move_constructible<T> and std::move_constructible<E> and (not trivial)
+                and std::is_move_assignable_v<T> and std::is_move_assignable_v<E>
+                and (std::is_nothrow_move_constructible_v<T> or std::is_nothrow_move_constructible_v<E>)
+        {
+            if (this != std::addressof(other)) {
+                assign_from(std::move(other));
+            }
+            return *this;
+        }
+
+        constexpr ~Expected() requires std::is_trivially_destructible_v<T> and std::is_trivially_destructible_v<E>
+            = default;
+
+        constexpr ~Expected() {
+            destroy();
+        }
+
+        constexpr auto has_value() const noexcept -> bool {
+            return has;
+        }
+
+        constexpr explicit operator bool() const noexcept {
+            return has;
+        }
+
+        /**
+        * The value, unchecked.
+        */
+        constexpr auto operator*() & noexcept -> T & {
+            return val;
+        }
+
+        constexpr auto operator*() const & noexcept -> const T & {
+            return val;
+        }
+
+        constexpr auto operator*() && noexcept -> T && {
+            return std::move(val);
+        }
+
+        constexpr auto operator*() const && noexcept -> const T && {
+            return std::move(val);
+        }
+
+        constexpr auto operator->() noexcept -> T * {
+            return std::addressof(val);
+        }
+
+        constexpr auto operator->() const noexcept -> const T * {
+            return std::addressof(val);
+        }
+
+        /**
+        * The value, or throws BadExpectedAccess with a copy of the error.
+        */
+        constexpr auto value() & -> T & {
+            if (not has) {
+                throw BadExpectedAccess<E>(err);
+            }
+            return val;
+        }
+
+        constexpr auto value() const & -> const T & {
+            if (not has) {
+                throw BadExpectedAccess<E>(err);
+            }
+            return val;
+        }
+
+        constexpr auto value() && -> T && {
+            if (not has) {
+                throw BadExpectedAccess<E>(std::move(err));
+            }
+            return std::move(val);
+        }
+
+        /**
+        * The error, unchecked.
+        */
+        constexpr auto error() & noexcept -> E & {
+            return err;
+        }
+
+        constexpr auto error() const & noexcept -> const E & {
+            return err;
+        }
+
+        constexpr auto error() && noexcept -> E && {
+            return std::move(err);
+        }
+
+        template<typename U>
+        constexpr auto value_or(U &&u) const & -> T {
+            return has ? val : static_cast<T>(std::forward<U>(u));
+        }
+
+        template<typename U>
+        constexpr auto value_or(U &&u) && -> T {
+            return has ? std::move(val) : static_cast<T>(std::forward<U>(u));
+        }
+
+        /**
+        * Lift : (T -> U) -> (Expected\<T, E> -> Expected\<U, E>), and
+        * flatlift : (T -> Expected\<U, E>) -> (Expected\<T, E> -> Expected\<U, E>), keeping the error if there is one.
+        */
+        template<class F>
+            requires std::invocable<F, const T &>
+        constexpr auto operator>>(F &&f) const &
+            noexcept(std::is_nothrow_invocable_v<F, const T &> and std::is_nothrow_copy_constructible_v<E>)
+                -> liated::expected_rewrap_t<std::invoke_result_t<F, const T &>, E>
+        {
+            if (has) {
+                return std::invoke(std::forward<F>(f), val);
+            } else {
+                return liated::expected_rewrap_t<std::invoke_result_t<F, const T &>, E>(unexpect, err);
+            }
+        }
+
+        template<class F>
+            requires std::invocable<F, T &&>
+        constexpr auto operator>>(F &&f) &&
+            noexcept(std::is_nothrow_invocable_v<F, T &&> and std::is_nothrow_move_constructible_v<E>)
+                -> liated::expected_rewrap_t<std::invoke_result_t<F, T &&>, E>
+        {
+            if (has) {
+                return std::invoke(std::forward<F>(f), std::move(val));
+            } else {
+                return liated::expected_rewrap_t<std::invoke_result_t<F, T &&>, E>(unexpect, std::move(err));
+            }
+        }
+    };
+}
+
 #endif//UNDERSCORE_CPP_MONADS_HPP
@@ -1,7 +1,10 @@
 #ifndef UNDERSCORE_CPP_MULTIARGS_HPP
 #define UNDERSCORE_CPP_MULTIARGS_HPP
 
+#include <cstddef>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "interfaces.hpp"
 #include "tmf.hpp"
@@ -16,17 +19,41 @@ namespace fff {
     struct MultiReturn : public std::tuple<Ts...> {
         using std::tuple<Ts...>::tuple;
 
-        constexpr auto to_tuple() const noexcept -> std::tuple<Ts...> {
-            return static_cast<std::tuple<Ts...>>(*this);
+        /**
+        * The tuple base itself, not a copy: an rvalue MultiReturn gives an rvalue tuple,
+        * so std::apply moves the elements out of it.
+        */
+        constexpr auto to_tuple() & noexcept -> std::tuple<Ts...> & {
+            return *this;
         }
 
-        template<std::invocable<Ts...> F>
-        constexpr auto operator>>(F &&f) const
+        constexpr auto to_tuple() const & noexcept -> const std::tuple<Ts...> & {
+            return *this;
+        }
+
+        constexpr auto to_tuple() && noexcept -> std::tuple<Ts...> && {
+            return std::move(*this);
+        }
+
+        constexpr auto to_tuple() const && noexcept -> const std::tuple<Ts...> && {
+            return std::move(*this);
+        }
+
+        template<std::invocable<const Ts &...> F>
+        constexpr auto operator>>(F &&f) const &
             noexcept(noexcept(std::apply(std::forward<F>(f), this->to_tuple())))
-                -> std::invoke_result_t<F, Ts...>
+                -> std::invoke_result_t<F, const Ts &...>
         {
             return std::apply(std::forward<F>(f), this->to_tuple());
         }
+
+        template<std::invocable<Ts...> F>
+        constexpr auto operator>>(F &&f) &&
+            noexcept(noexcept(std::apply(std::forward<F>(f), std::move(*this).to_tuple())))
+                -> std::invoke_result_t<F, Ts...>
+        {
+            return std::apply(std::forward<F>(f), std::move(*this).to_tuple());
+        }
     };
 
     namespace factory {
@@ -62,23 +89,34 @@ namespace fff {
     concept not_mr = not mr<T>;
 
     namespace liated {
-        struct DeclMr {
-            template<typename F, typename ...Ts>
-            constexpr static auto declmr(F &&f, const MultiReturn<Ts...> &) noexcept
-                -> std::invoke_result_t<F, Ts...>;
+        /**
+        * std::invoke_result for std::apply: no member type if F cannot take the elements of Tuple.
+        */
+        template<typename F, typename Tuple,
+                 typename = std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<Tuple>>>>
+        struct apply_result {};
+
+        template<typename F, typename Tuple, std::size_t ...I>
+            requires std::invocable<F, decltype(std::get<I>(std::declval<Tuple>()))...>
+        struct apply_result<F, Tuple, std::index_sequence<I...>> {
+            using type = std::invoke_result_t<F, decltype(std::get<I>(std::declval<Tuple>()))...>;
         };
     }
 
+    /**
+     * The result of spreading the multi-return T over the parameters of F.
+     * The elements of an rvalue T are passed as rvalues, those of an lvalue T as lvalues.
+     */
+    template<typename F, mr T>
+    using apply_as_mr_result_t =
+        typename liated::apply_result<F, decltype(std::declval<T>().to_tuple())>::type;
+
     template<typename F, typename T>
     concept applicable = mr<T> and
-        requires (F f, T t) {
-            std::apply(f, t.to_tuple());
+        requires {
+            typename apply_as_mr_result_t<F, T>;
         };
 
-    template<typename F, mr T>
-    using apply_as_mr_result_t =
-        decltype(liated::DeclMr::declmr(std::declval<F>(), std::declval<T>()));
-
     constexpr inline factory::MR multi_return;
 }
 
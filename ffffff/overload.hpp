@@ -1,17 +1,92 @@
 #ifndef UNDERSCORE_CPP_OVERLOAD_HPP
 #define UNDERSCORE_CPP_OVERLOAD_HPP
 
-#include <type_traits>
+#include <array>
+#include <cstddef>
 #include <functional>
+#include <type_traits>
 #include <utility>
+#include <variant>
+
+#include "tmf.hpp"
 
 /*
 * fff::Overload Reducible_TD
 */
+/*
+* fff::visit
+*/
+namespace fff {
+
+    namespace liated {
+        template<typename R, class F, typename V, std::size_t I>
+        constexpr auto visit_entry(F &&f, V &&v) -> R {
+            if constexpr (std::is_void_v<R>) {
+                std::invoke(std::forward<F>(f), std::get<I>(std::forward<V>(v)));
+            } else {
+                return std::invoke(std::forward<F>(f), std::get<I>(std::forward<V>(v)));
+            }
+        }
+
+        template<typename R, class F, typename V, std::size_t ...I>
+        constexpr auto make_visit_table(std::index_sequence<I...>) noexcept {
+            return std::array<R (*)(F &&, V &&), sizeof...(I)>{&visit_entry<R, F, V, I>...};
+        }
+
+        template<typename V>
+        using variant_indices = std::make_index_sequence<std::variant_size_v<std::remove_cvref_t<V>>>;
+
+        /**
+        * One function pointer per alternative of V, indexed by V::index().
+        */
+        template<typename R, class F, typename V>
+        constexpr inline auto visit_table = make_visit_table<R, F, V>(variant_indices<V>());
+
+        template<class F, typename V, std::size_t ...I>
+        auto visit_result(std::index_sequence<I...>)
+            -> std::common_type_t<std::invoke_result_t<F, decltype(std::get<I>(std::declval<V>()))>...>;
+
+        template<class F, typename V>
+        using visit_result_t = decltype(visit_result<F, V>(variant_indices<V>()));
+    }
+
+    /**
+    * std::visit for one variant through a flat constexpr table: v.index() picks the function pointer that calls
+    * f with the alternative, so each call is one indirect jump however many alternatives there are.
+    * With a Parallel, the handler of every alternative is the first one that accepts it, as in a direct call.
+    * @return the result converted to R
+    * @throw std::bad_variant_access if v is valueless_by_exception
+    */
+    template<typename R, class F, typename V>
+    constexpr auto visit(F &&f, V &&v) -> R {
+        if (v.valueless_by_exception()) {
+            throw std::bad_variant_access();
+        }
+        return liated::visit_table<R, F, V>[v.index()](std::forward<F>(f), std::forward<V>(v));
+    }
+
+    /**
+    * Same as above, returning the common type of what f returns for the alternatives.
+    * @example fff::visit(fff::parallel(on_login, on_logout, [](const auto &) {return 0;}), message)
+    */
+    template<class F, typename V>
+    constexpr auto visit(F &&f, V &&v) -> liated::visit_result_t<F, V> {
+        return visit<liated::visit_result_t<F, V>>(std::forward<F>(f), std::forward<V>(v));
+    }
+}
+
 namespace fff {
     template<class ...Fp>
     struct Overload : Fp... {
         using Fp::operator()...;
+
+        /**
+        * fff::visit(*this, v)
+        */
+        template<typename V>
+        constexpr auto visit(V &&v) const -> liated::visit_result_t<const Overload &, V> {
+            return fff::visit(*this, std::forward<V>(v));
+        }
     };
 
     struct OverloadFactory {
@@ -29,171 +104,112 @@ namespace fff {
 */
 
 namespace fff {
-    template<class F, class ...Fp>
-    class Parallel;
-
-    template<class F>
-    class Parallel<F> {
-        friend class ParallelFactory;
-
-        [[no_unique_address]] F f;
+    /**
+    * Parallel\<F1, ..., Fn>(args...) calls the first Fi that is invocable with args.\n
+    * The functions are stored side by side, and the one to call is found by a single constexpr search,
+    * so the number of alternatives does not add to the instantiation depth.
+    */
+    template<class ...Fs>
+    class Parallel {
+        static_assert(sizeof...(Fs) > 0, "fff::Parallel : needs at least one function");
 
-    public:
-        constexpr explicit Parallel(const F &f) noexcept : f(f) {}
-        constexpr explicit Parallel(F &&f) noexcept : f(std::move(f)) {}
+        [[no_unique_address]] liated::flat_pack<Fs...> fns;
 
-        template<typename ...Args>
-            requires std::invocable<F, Args...>
-        constexpr auto operator()(Args &&...args) const &
-            noexcept(noexcept(std::invoke(f, std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
-        {
-            return std::invoke(f, std::forward<Args>(args)...);
+        template<std::size_t I, class Self>
+        constexpr static auto at(Self &&self) noexcept -> decltype(auto) {
+            return liated::get_leaf<I>(std::forward<Self>(self).fns);
         }
 
-        template<typename ...Args>
-            requires std::invocable<F, Args...>
-        constexpr auto operator()(Args &&...args) &&
-            noexcept(noexcept(std::invoke(std::move(f), std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
-        {
-            return std::invoke(std::move(f), std::forward<Args>(args)...);
+        // the index of the function a Self called with Args goes to
+        template<class Self, std::size_t ...I, typename ...Args>
+        constexpr static auto pick(std::index_sequence<I...>, std::type_identity<Args>...) noexcept -> std::size_t {
+            return liated::first_true_v<std::invocable<decltype(at<I>(std::declval<Self>())), Args...>...>;
         }
 
-        template<typename ...Args>
-            requires std::invocable<F, Args...>
-        constexpr auto operator()(Args &&...args) const &&
-            noexcept(noexcept(std::invoke(std::move(f), std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
+        template<class Self, typename ...Args,
+                 std::size_t I = pick<Self>(std::index_sequence_for<Fs...>(), std::type_identity<Args>()...)>
+            requires (I < sizeof...(Fs))
+        constexpr static auto call(Self &&self, Args &&...args)
+            noexcept(std::is_nothrow_invocable_v<decltype(at<I>(std::declval<Self>())), Args...>)
+                -> std::invoke_result_t<decltype(at<I>(std::declval<Self>())), Args...>
         {
-            return std::invoke(std::move(f), std::forward<Args>(args)...);
-        }
-
-        template<typename G>
-        constexpr auto make_chain(G &&g) const & noexcept -> Parallel<F, std::decay_t<G>> {
-            return Parallel<F, std::decay_t<G>>{f, std::forward<G>(g)};
-        }
-
-        template<typename G>
-        constexpr auto make_chain(G &&g) && noexcept -> Parallel<F, std::decay_t<G>> {
-            return Parallel<F, std::decay_t<G>>{std::move(f), std::forward<G>(g)};
+            return std::invoke(at<I>(std::forward<Self>(self)), std::forward<Args>(args)...);
         }
 
-        template<typename G>
-        constexpr auto make_chain(G &&g) const && noexcept -> Parallel<F, std::decay_t<G>> {
-            return Parallel<F, std::decay_t<G>>{std::move(f), std::forward<G>(g)};
+        template<class Self, typename G, std::size_t ...I>
+        constexpr static auto append(Self &&self, G &&g, std::index_sequence<I...>) noexcept
+            -> Parallel<Fs..., std::decay_t<G>>
+        {
+            return Parallel<Fs..., std::decay_t<G>>(at<I>(std::forward<Self>(self))..., std::forward<G>(g));
         }
-    };
-
-    template<class F, class ...Fp>
-    class Parallel {
-        friend class ParallelFactory;
-
-        [[no_unique_address]] F f;
-        [[no_unique_address]] Parallel<Fp...> pfp;
 
     public:
-        template<class U1, class U2>
-        constexpr Parallel(U1 &&f, U2 &&pfp) noexcept
-            : f(std::forward<U1>(f)), pfp(std::forward<U2>(pfp)) {}
+        template<class ...Us>
+            requires (sizeof...(Us) == sizeof...(Fs))
+                and (std::constructible_from<Fs, Us> and ...)
+                and (not std::same_as<std::remove_cvref_t<Us>, Parallel> and ...)
+        constexpr explicit Parallel(Us &&...fs) noexcept
+            : fns(std::in_place, std::forward<Us>(fs)...) {}
 
         template<typename ...Args>
-            requires std::invocable<F, Args...>
         constexpr auto operator()(Args &&...args) const &
-            noexcept(noexcept(std::invoke(f, std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
+            noexcept(noexcept(call(std::declval<const Parallel &>(), std::forward<Args>(args)...)))
+                -> decltype(call(std::declval<const Parallel &>(), std::forward<Args>(args)...))
         {
-            return std::invoke(f, std::forward<Args>(args)...);
+            return call(*this, std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
-            requires std::invocable<F, Args...>
         constexpr auto operator()(Args &&...args) &&
-            noexcept(noexcept(std::invoke(std::move(f), std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
+            noexcept(noexcept(call(std::declval<Parallel>(), std::forward<Args>(args)...)))
+                -> decltype(call(std::declval<Parallel>(), std::forward<Args>(args)...))
         {
-            return std::invoke(std::move(f), std::forward<Args>(args)...);
+            return call(std::move(*this), std::forward<Args>(args)...);
         }
 
         template<typename ...Args>
-            requires std::invocable<F, Args...>
         constexpr auto operator()(Args &&...args) const &&
-            noexcept(noexcept(std::invoke(std::move(f), std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
-        {
-            return std::invoke(std::move(f), std::forward<Args>(args)...);
-        }
-
-        template<typename ...Args>
-            requires (not std::invocable<F, Args...>
-                     and std::invocable<Parallel<Fp...>, Args...>)
-        constexpr auto operator()(Args &&...args) const &
-            noexcept(noexcept(std::invoke(pfp, std::forward<Args>(args)...)))
-                -> std::invoke_result_t<Parallel<Fp...>, Args...>
-        {
-            return std::invoke(pfp, std::forward<Args>(args)...);
-        }
-
-        template<typename ...Args>
-            requires (not std::invocable<F, Args...>
-                     and std::invocable<Parallel<Fp...>, Args...>)
-        constexpr auto operator()(Args &&...args) &&
-            noexcept(noexcept(std::invoke(std::move(pfp), std::forward<Args>(args)...)))
-                -> std::invoke_result_t<Parallel<Fp...>, Args...>
+            noexcept(noexcept(call(std::declval<const Parallel>(), std::forward<Args>(args)...)))
+                -> decltype(call(std::declval<const Parallel>(), std::forward<Args>(args)...))
         {
-            return std::invoke(std::move(pfp), std::forward<Args>(args)...);
+            return call(std::move(*this), std::forward<Args>(args)...);
         }
 
-        template<typename ...Args>
-            requires (not std::invocable<F, Args...>
-                     and std::invocable<Parallel<Fp...>, Args...>)
-        constexpr auto operator()(Args &&...args) const &&
-            noexcept(noexcept(std::invoke(std::move(pfp), std::forward<Args>(args)...)))
-                -> std::invoke_result_t<Parallel<Fp...>, Args...>
-        {
-            return std::invoke(std::move(pfp), std::forward<Args>(args)...);
+        /**
+        * fff::visit(*this, v): the first function that accepts the alternative v holds, found with one jump.
+        */
+        template<typename V>
+        constexpr auto visit(V &&v) const -> liated::visit_result_t<const Parallel &, V> {
+            return fff::visit(*this, std::forward<V>(v));
         }
 
         template<typename G>
-        constexpr auto make_chain(G &&g) const & noexcept
-            -> Parallel<F, Fp..., std::decay_t<G>>
-        {
-            return Parallel<F, Fp..., std::decay_t<G>>{f, pfp.make_chain(std::forward<G>(g))};
+        constexpr auto make_chain(G &&g) const & noexcept -> Parallel<Fs..., std::decay_t<G>> {
+            return append(*this, std::forward<G>(g), std::index_sequence_for<Fs...>());
         }
 
         template<typename G>
-        constexpr auto make_chain(G &&g) && noexcept
-            -> Parallel<F, Fp..., std::decay_t<G>>
-        {
-            return Parallel<F, Fp..., std::decay_t<G>>{std::move(f), pfp.make_chain(std::forward<G>(g))};
+        constexpr auto make_chain(G &&g) && noexcept -> Parallel<Fs..., std::decay_t<G>> {
+            return append(std::move(*this), std::forward<G>(g), std::index_sequence_for<Fs...>());
         }
 
         template<typename G>
-        constexpr auto make_chain(G &&g) const && noexcept
-            -> Parallel<F, Fp..., std::decay_t<G>>
-        {
-            return Parallel<F, Fp..., std::decay_t<G>>{std::move(f), pfp.make_chain(std::forward<G>(g))};
+        constexpr auto make_chain(G &&g) const && noexcept -> Parallel<Fs..., std::decay_t<G>> {
+            return append(std::move(*this), std::forward<G>(g), std::index_sequence_for<Fs...>());
         }
     };
 
     struct ParallelFactory {
-        template<class F>
-        constexpr auto operator()(F &&f) const noexcept -> Parallel<std::decay_t<F>>
-        {
-            return Parallel<std::decay_t<F>>(std::forward<F>(f));
-        }
-
         template<class F, class ...Fp>
         constexpr auto operator()(F &&f, Fp &&...fp) const noexcept
             -> Parallel<std::decay_t<F>, std::decay_t<Fp>...>
         {
-            return Parallel<std::decay_t<F>, std::decay_t<Fp>...>
-                (std::forward<F>(f), operator()(std::forward<Fp>(fp)...));
+            return Parallel<std::decay_t<F>, std::decay_t<Fp>...>(std::forward<F>(f), std::forward<Fp>(fp)...);
         }
 
         template<typename F>
         constexpr auto make_chain(F &&f) const noexcept -> Parallel<std::decay_t<F>> {
-            return Parallel<F>{std::forward<F>(f)};
+            return Parallel<std::decay_t<F>>(std::forward<F>(f));
         }
     };
 
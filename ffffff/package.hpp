@@ -5,15 +5,32 @@
 #ifndef UNDERSCORE_CPP_PACKAGE_HPP
 #define UNDERSCORE_CPP_PACKAGE_HPP
 
+#include "async.hpp"
 #include "basic_ops.hpp"
+#include "batch.hpp"
 #include "bind.hpp"
+#include "concurrency.hpp"
+#include "execution.hpp"
+#include "flat_hash_map.hpp"
+#include "executor.hpp"
+#include "function.hpp"
 #include "functors.hpp"
 #include "interfaces.hpp"
+#include "lazy.hpp"
+#include "memoize.hpp"
+#include "memory.hpp"
 #include "monads.hpp"
 #include "multiargs.hpp"
 #include "overload.hpp"
 #include "pipeline.hpp"
+#include "pool.hpp"
+#include "profile.hpp"
+#include "records.hpp"
 #include "reducible.hpp"
+#include "simd.hpp"
+#include "soa.hpp"
+#include "static_pipeline.hpp"
+#include "stream.hpp"
 #include "tmf.hpp"
 #include "utils.hpp"
 
@@ -1,170 +1,237 @@
 #ifndef UNDERSCORE_CPP_PIPELINE_HPP
 #define UNDERSCORE_CPP_PIPELINE_HPP
 
+#include <cstddef>
 #include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
+#include "monads.hpp"
 #include "multiargs.hpp"
 
 namespace fff {
 
-    template<class F, class ...Fp>
-    struct Pipeline;
-
-    template<class F>
-    class Pipeline<F> {
-        friend class PipelineFactory;
-
-        [[no_unique_address]] F f;
-
-    public:
-        constexpr explicit Pipeline(const F &f) noexcept : f(f) {}
-        constexpr explicit Pipeline(F &&f) noexcept : f(std::move(f)) {}
-
-        template<class ...Args>
-            requires std::invocable<F, Args...>
-        constexpr auto operator()(Args &&...args) const &
-            noexcept(noexcept(std::invoke(f, std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
+    namespace liated {
+
+        template<class Stage, typename In>
+        concept direct_stage_invocable = (mr<In> and applicable<Stage, In>)
+            or (not_mr<In> and std::invocable<Stage, In>);
+
+        /**
+        * A stage whose only call signature names the Expected In as its first parameter, e.g. to recover from the error.
+        */
+        template<class Stage, typename In>
+        concept takes_expected = has_signature<std::decay_t<Stage>>
+            and std::tuple_size_v<typename signature_args<std::decay_t<Stage>>::type> != 0
+            and std::same_as<std::remove_cvref_t<std::tuple_element_t<0, typename signature_args<std::decay_t<Stage>>::type>>,
+                             std::remove_cvref_t<In>>;
+
+        /**
+        * A stage that is handed the value of an Expected In: any stage that takes the value, unless it declares
+        * the Expected itself as its parameter. The value is tried first, so that a generic stage
+        * like [](auto x) {return x * 2;} is never instantiated with the Expected.
+        */
+        template<class Stage, typename In>
+        concept expected_stage_invocable = expectedtype<std::remove_cvref_t<In>>
+            and (not takes_expected<Stage, In>)
+            and direct_stage_invocable<Stage, decltype(*std::declval<In>())>;
+
+        /**
+        * Whether a Pipeline can pass an In to stage: spread over its parameters if In is a MultiReturn,
+        * the value inside if In is an Expected and the stage takes the value, as is otherwise.
+        */
+        template<class Stage, typename In>
+        concept stage_invocable = expected_stage_invocable<Stage, In> or direct_stage_invocable<Stage, In>;
+
+        /**
+        * Calls stage with in, spreading in over the parameters if it is a MultiReturn, as Pipeline does.
+        */
+        template<class Stage, typename In>
+            requires not_mr<In> and (not expected_stage_invocable<Stage, In>) and std::invocable<Stage, In>
+        constexpr auto call_stage(Stage &&stage, In &&in)
+            noexcept(std::is_nothrow_invocable_v<Stage, In>)
+                -> std::invoke_result_t<Stage, In>
         {
-            return std::invoke(f, std::forward<Args>(args)...);
+            return std::invoke(std::forward<Stage>(stage), std::forward<In>(in));
         }
 
-        template<class ...Args>
-            requires std::invocable<F, Args...>
-        constexpr auto operator()(Args &&...args) &&
-            noexcept(noexcept(std::invoke(std::move(f), std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
+        template<class Stage, typename In>
+            requires applicable<Stage, In>
+        constexpr auto call_stage(Stage &&stage, In &&in)
+            noexcept(noexcept(std::apply(std::forward<Stage>(stage), std::forward<In>(in).to_tuple())))
+                -> apply_as_mr_result_t<Stage, In>
         {
-            return std::invoke(std::move(f), std::forward<Args>(args)...);
+            return std::apply(std::forward<Stage>(stage), std::forward<In>(in).to_tuple());
         }
 
-        template<class ...Args>
-            requires std::invocable<F, Args...>
-        constexpr auto operator()(Args &&...args) const &&
-            noexcept(noexcept(std::invoke(std::move(f), std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
+        /**
+        * Calls stage with the value of in, or skips it and passes the error on.
+        */
+        template<class Stage, typename In>
+            requires expected_stage_invocable<Stage, In>
+        constexpr auto call_stage(Stage &&stage, In &&in)
+            noexcept(noexcept(call_stage(std::forward<Stage>(stage), *std::forward<In>(in)))
+                     and std::is_nothrow_constructible_v<typename std::remove_cvref_t<In>::error_type,
+                                                         decltype(std::forward<In>(in).error())>)
+                -> expected_rewrap_t<decltype(call_stage(std::forward<Stage>(stage), *std::forward<In>(in))),
+                                     typename std::remove_cvref_t<In>::error_type>
         {
-            return std::invoke(std::move(f), std::forward<Args>(args)...);
-        }
-
-        template<class G>
-        constexpr auto operator|(G &&g) const & noexcept -> Pipeline<F, std::decay_t<G>> {
-            return Pipeline<F, std::decay_t<G>>{f, std::forward<G>(g)};
+            using R = expected_rewrap_t<decltype(call_stage(std::forward<Stage>(stage), *std::forward<In>(in))),
+                                        typename std::remove_cvref_t<In>::error_type>;
+
+            if (in.has_value()) [[likely]] {
+                return call_stage(std::forward<Stage>(stage), *std::forward<In>(in));
+            } else {
+                return R(unexpect, std::forward<In>(in).error());
+            }
         }
 
-        template<class G>
-        constexpr auto operator|(G &&g) && noexcept -> Pipeline<F, std::decay_t<G>> {
-            return Pipeline<F, std::decay_t<G>>{std::move(f), std::forward<G>(g)};
+        /**
+        * The value between two stages of a Pipeline. Carry\<T>{v} ->* stage is Carry{call_stage(stage, v)},
+        * so a whole pipeline is one fold expression over its stages instead of nested calls.
+        */
+        template<typename T>
+        struct Carry {
+            T value;
+        };
+
+        template<typename T, class Stage>
+            requires stage_invocable<Stage, T>
+        constexpr auto operator->*(Carry<T> &&carry, Stage &&stage)
+            noexcept(noexcept(call_stage(std::forward<Stage>(stage), std::forward<T>(carry.value))))
+                -> Carry<decltype(call_stage(std::forward<Stage>(stage), std::forward<T>(carry.value)))>
+        {
+            return {call_stage(std::forward<Stage>(stage), std::forward<T>(carry.value))};
         }
 
-        template<class G>
-        constexpr auto operator|(G &&g) const && noexcept -> Pipeline<F, std::decay_t<G>> {
-            return Pipeline<F, std::decay_t<G>>{std::move(f), std::forward<G>(g)};
+        template<typename T>
+        constexpr auto carried(Carry<T> &&carry) noexcept -> T && {
+            return std::forward<T>(carry.value);
         }
-    };
+    }
 
-    template<class F1, class ...Fp>
+    /**
+    * Pipeline\<F1, F2, ..., Fn>(args...) = Fn(...F2(F1(args...))).
+    * A MultiReturn between two stages is spread over the parameters of the next one.\n
+    * The stages are stored side by side and called by one fold over an index_sequence,
+    * so neither the type nor a call nests as deep as the number of stages.
+    */
+    template<class ...Fs>
     class Pipeline {
-        friend class PipelineFactory;
+        static_assert(sizeof...(Fs) > 0, "fff::Pipeline : a pipeline needs at least one function");
 
-        [[no_unique_address]] F1 f1;
-        [[no_unique_address]] Pipeline<Fp...> f2;
+        [[no_unique_address]] liated::flat_pack<Fs...> stages;
 
-    public:
-        template<class U1, class U2>
-        constexpr Pipeline(U1 &&f1, U2 &&f2) noexcept
-            : f1(std::forward<U1>(f1)), f2(std::forward<U2>(f2)) {}
+        template<std::size_t I, class Self>
+        constexpr static auto at(Self &&self) noexcept -> decltype(auto) {
+            return liated::get_leaf<I>(std::forward<Self>(self).stages);
+        }
 
-        template<class ...Args>
-            requires not_mr<std::invoke_result_t<F1, Args...>>
-        constexpr auto operator()(Args &&...args) const &
-            noexcept(noexcept(std::invoke(f2, std::invoke(f1, std::forward<Args>(args)...))))
-                -> std::invoke_result_t<Pipeline<Fp...>, std::invoke_result_t<F1, Args...>>
+        template<class Self, class ...Args>
+        constexpr static auto start(Self &&self, Args &&...args)
+            noexcept(std::is_nothrow_invocable_v<decltype(at<0>(std::forward<Self>(self))), Args...>)
+                -> liated::Carry<std::invoke_result_t<decltype(at<0>(std::forward<Self>(self))), Args...>>
         {
-            return std::invoke(f2, std::invoke(f1, std::forward<Args>(args)...));
+            return {std::invoke(at<0>(std::forward<Self>(self)), std::forward<Args>(args)...)};
         }
 
-        template<class ...Args>
-            requires not_mr<std::invoke_result_t<F1, Args...>>
-        constexpr auto operator()(Args &&...args) &&
-            noexcept(noexcept(std::invoke(std::move(f2), std::invoke(std::move(f1), std::forward<Args>(args)...))))
-                -> std::invoke_result_t<Pipeline<Fp...>, std::invoke_result_t<F1, Args...>>
+        template<class Self, class ...Args>
+            requires (sizeof...(Fs) == 1)
+        constexpr static auto run(Self &&self, std::index_sequence<>, Args &&...args)
+            noexcept(std::is_nothrow_invocable_v<decltype(at<0>(std::forward<Self>(self))), Args...>)
+                -> std::invoke_result_t<decltype(at<0>(std::forward<Self>(self))), Args...>
         {
-            return std::invoke(std::move(f2), std::invoke(std::move(f1), std::forward<Args>(args)...));
+            return std::invoke(at<0>(std::forward<Self>(self)), std::forward<Args>(args)...);
         }
 
-        template<class ...Args>
-            requires not_mr<std::invoke_result_t<F1, Args...>>
-        constexpr auto operator()(Args &&...args) const &&
-            noexcept(noexcept(std::invoke(std::move(f2), std::invoke(std::move(f1), std::forward<Args>(args)...))))
-                -> std::invoke_result_t<Pipeline<Fp...>, std::invoke_result_t<F1, Args...>>
+        // stage 0 takes the arguments as they are, the stages I + 1 carry the value along, the last one returns it
+        template<class Self, std::size_t ...I, class ...Args>
+            requires (sizeof...(Fs) > 1)
+        constexpr static auto run(Self &&self, std::index_sequence<I...>, Args &&...args)
+            noexcept(noexcept(liated::call_stage(at<sizeof...(Fs) - 1>(std::forward<Self>(self)), liated::carried(
+                (start(std::forward<Self>(self), std::forward<Args>(args)...) ->* ... ->* at<I + 1>(std::forward<Self>(self)))))))
+                -> decltype(liated::call_stage(at<sizeof...(Fs) - 1>(std::forward<Self>(self)), liated::carried(
+                    (start(std::forward<Self>(self), std::forward<Args>(args)...) ->* ... ->* at<I + 1>(std::forward<Self>(self))))))
+        {
+            return liated::call_stage(at<sizeof...(Fs) - 1>(std::forward<Self>(self)), liated::carried(
+                (start(std::forward<Self>(self), std::forward<Args>(args)...) ->* ... ->* at<I + 1>(std::forward<Self>(self)))));
+        }
+
+        template<class Self, class G, std::size_t ...I>
+        constexpr static auto append(Self &&self, G &&g, std::index_sequence<I...>) noexcept
+            -> Pipeline<Fs..., std::decay_t<G>>
         {
-            return std::invoke(std::move(f2), std::invoke(std::move(f1), std::forward<Args>(args)...));
+            return Pipeline<Fs..., std::decay_t<G>>{at<I>(std::forward<Self>(self))..., std::forward<G>(g)};
+        }
+
+        using middle = std::make_index_sequence<sizeof...(Fs) == 1 ? 0 : sizeof...(Fs) - 2>;
+
+    public:
+        constexpr static std::size_t size = sizeof...(Fs);
+
+        template<class ...Us>
+            requires (sizeof...(Us) == sizeof...(Fs))
+                and (std::constructible_from<Fs, Us> and ...)
+                and (not std::same_as<std::remove_cvref_t<Us>, Pipeline> and ...)
+        constexpr explicit Pipeline(Us &&...fs) noexcept
+            : stages(std::in_place, std::forward<Us>(fs)...) {}
+
+        /**
+        * The I-th function of the pipeline, counted from 0.
+        */
+        template<std::size_t I>
+            requires (I < size)
+        constexpr auto stage() const noexcept -> const auto & {
+            return at<I>(*this);
         }
 
         template<class ...Args>
-            requires mr<std::invoke_result_t<F1, Args...>>
         constexpr auto operator()(Args &&...args) const &
-            noexcept(noexcept(std::apply(f2, std::invoke(f1, std::forward<Args>(args)...).to_tuple())))
-                -> apply_as_mr_result_t<Pipeline<Fp...>, std::invoke_result_t<F1, Args...>>
+            noexcept(noexcept(run(std::declval<const Pipeline &>(), middle(), std::forward<Args>(args)...)))
+                -> decltype(run(std::declval<const Pipeline &>(), middle(), std::forward<Args>(args)...))
         {
-            return std::apply(f2, std::invoke(f1, std::forward<Args>(args)...).to_tuple());
+            return run(*this, middle(), std::forward<Args>(args)...);
         }
 
         template<class ...Args>
-            requires mr<std::invoke_result_t<F1, Args...>>
         constexpr auto operator()(Args &&...args) &&
-            noexcept(noexcept(std::apply(std::move(f2), std::invoke(std::move(f1), std::forward<Args>(args)...).to_tuple())))
-                -> apply_as_mr_result_t<Pipeline<Fp...>, std::invoke_result_t<F1, Args...>>
+            noexcept(noexcept(run(std::declval<Pipeline>(), middle(), std::forward<Args>(args)...)))
+                -> decltype(run(std::declval<Pipeline>(), middle(), std::forward<Args>(args)...))
         {
-            return std::apply(std::move(f2), std::invoke(std::move(f1), std::forward<Args>(args)...).to_tuple());
+            return run(std::move(*this), middle(), std::forward<Args>(args)...);
         }
 
         template<class ...Args>
-            requires mr<std::invoke_result_t<F1, Args...>>
         constexpr auto operator()(Args &&...args) const &&
-            noexcept(noexcept(std::apply(std::move(f2), std::invoke(std::move(f1), std::forward<Args>(args)...).to_tuple())))
-                -> apply_as_mr_result_t<Pipeline<Fp...>, std::invoke_result_t<F1, Args...>>
+            noexcept(noexcept(run(std::declval<const Pipeline>(), middle(), std::forward<Args>(args)...)))
+                -> decltype(run(std::declval<const Pipeline>(), middle(), std::forward<Args>(args)...))
         {
-            return std::apply(std::move(f2), std::invoke(std::move(f1), std::forward<Args>(args)...).to_tuple());
+            return run(std::move(*this), middle(), std::forward<Args>(args)...);
         }
 
         template<class G>
-        constexpr auto operator|(G &&g) const & noexcept
-            -> Pipeline<F1, Fp..., std::decay_t<G>>
-        {
-            return Pipeline<F1, Fp..., std::decay_t<G>>{f1, f2 | std::forward<G>(g)};
+        constexpr auto operator|(G &&g) const & noexcept -> Pipeline<Fs..., std::decay_t<G>> {
+            return append(*this, std::forward<G>(g), std::index_sequence_for<Fs...>());
         }
 
         template<class G>
-        constexpr auto operator|(G &&g) && noexcept
-            -> Pipeline<F1, Fp..., std::decay_t<G>>
-        {
-            return Pipeline<F1, Fp..., std::decay_t<G>>{std::move(f1), std::move(f2) | std::forward<G>(g)};
+        constexpr auto operator|(G &&g) && noexcept -> Pipeline<Fs..., std::decay_t<G>> {
+            return append(std::move(*this), std::forward<G>(g), std::index_sequence_for<Fs...>());
         }
 
         template<class G>
-        constexpr auto operator|(G &&g) const && noexcept
-            -> Pipeline<F1, Fp..., std::decay_t<G>>
-        {
-            return Pipeline<F1, Fp..., std::decay_t<G>>{std::move(f1), std::move(f2) | std::forward<G>(g)};
+        constexpr auto operator|(G &&g) const && noexcept -> Pipeline<Fs..., std::decay_t<G>> {
+            return append(std::move(*this), std::forward<G>(g), std::index_sequence_for<Fs...>());
         }
     };
 
     struct PipelineFactory {
-        template<class F>
-        constexpr auto operator()(F &&f) const noexcept
-            -> Pipeline<std::decay_t<F>>
-        {
-            return Pipeline<std::decay_t<F>>{std::forward<F>(f)};
-        }
-
         template<class F, class ...Fp>
         constexpr auto operator()(F &&f, Fp &&...fp) const noexcept
             -> Pipeline<std::decay_t<F>, std::decay_t<Fp>...>
         {
-            return Pipeline<std::decay_t<F>, std::decay_t<Fp>...>
-                {std::forward<F>(f), operator()(std::forward<Fp>(fp)...)};
+            return Pipeline<std::decay_t<F>, std::decay_t<Fp>...>{std::forward<F>(f), std::forward<Fp>(fp)...};
         }
 
         template<class F>
@@ -178,7 +245,8 @@ namespace fff {
 
 
 namespace fff::pipe_op {
-    template<typename T, std::invocable<T> F>
+    template<typename T, class F>
+        requires (not liated::expected_stage_invocable<F, T>) and std::invocable<F, T>
     constexpr auto operator|(T &&t, F &&f)
         noexcept(std::is_nothrow_invocable_v<F, T>)
             -> std::invoke_result_t<F, T>
@@ -186,6 +254,18 @@ namespace fff::pipe_op {
         return std::invoke(std::forward<F>(f), std::forward<T>(t));
     }
 
+    /**
+    * expected | f is f(the value of expected), or the error if there is one.
+    */
+    template<typename T, class F>
+        requires liated::expected_stage_invocable<F, T>
+    constexpr auto operator|(T &&t, F &&f)
+        noexcept(noexcept(liated::call_stage(std::forward<F>(f), std::forward<T>(t))))
+            -> decltype(liated::call_stage(std::forward<F>(f), std::forward<T>(t)))
+    {
+        return liated::call_stage(std::forward<F>(f), std::forward<T>(t));
+    }
+
     template<mr T, applicable<T> F>
     constexpr auto operator|(T &&t, F &&f)
         noexcept(noexcept(std::apply(std::forward<F>(f), std::forward<T>(t).to_tuple())))
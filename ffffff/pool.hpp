@@ -0,0 +1,236 @@
+#ifndef UNDERSCORE_CPP_POOL_HPP
+#define UNDERSCORE_CPP_POOL_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "pipeline.hpp"
+#include "utils.hpp"
+
+/*
+* fff::pool : objects kept for reuse on each thread, and the recycling mode of the functors
+*/
+namespace fff {
+
+    /**
+    * Objects of type T kept for reuse, in a free list of each thread: release() puts one back, cleared
+    * (with clear() if T has one) but keeping its capacity, and acquire() hands it out again before making a new one.
+    * Neither takes a lock, and an object may go back on another thread than the one that acquired it.\n
+    * ObjectCounter\<T> counts for the pool: recycled() is the number of objects acquire() took from a free list.
+    * If T does not derive from ObjectCounter\<T> (std::vector...), created() is the number of objects it made,
+    * so a loop that no longer allocates is one where created() stays the same.
+    * @example
+    * auto buf = fff::pool\<std::vector\<char>>::acquire();   // empty, with the capacity of the last one released
+    * fill(buf);
+    * fff::pool\<std::vector\<char>>::release(std::move(buf));
+    * @warning an object without clear() comes back in the state it was released in
+    */
+    template<typename T>
+        requires std::default_initializable<T> and std::move_constructible<T>
+    class pool {
+        static auto idle_list() -> std::vector<T> & {
+            thread_local std::vector<T> list;
+            return list;
+        }
+
+    public:
+        /**
+        * The most objects a free list keeps; release() destroys the ones past that.
+        */
+        constexpr static std::size_t max_idle = 64;
+
+        [[nodiscard]] static auto acquire() -> T {
+            auto &list = idle_list();
+            if (list.empty()) {
+                if constexpr (not std::derived_from<T, ObjectCounter<T>>) {
+                    ObjectCounter<T>::created_.fetch_add(1, std::memory_order_relaxed);
+                }
+                return T();
+            }
+
+            T t = std::move(list.back());
+            list.pop_back();
+            ObjectCounter<T>::recycled_.fetch_add(1, std::memory_order_relaxed);
+            return t;
+        }
+
+        static void release(T &&t) {
+            auto &list = idle_list();
+            if (list.size() == max_idle) {
+                return;
+            }
+            if constexpr (requires {t.clear();}) {
+                t.clear();
+            }
+            if (list.capacity() == 0) {
+                list.reserve(max_idle);
+            }
+            list.push_back(std::move(t));
+        }
+
+        /**
+        * The objects waiting in the free list of this thread.
+        */
+        static auto idle() noexcept -> std::size_t {
+            return idle_list().size();
+        }
+
+        /**
+        * Destroys the objects waiting in the free list of this thread.
+        */
+        static void trim() noexcept {
+            idle_list().clear();
+        }
+    };
+
+    namespace liated {
+        inline thread_local bool recycling = false;
+
+        /**
+        * The containers the functors take from a pool while recycling is on: std::vector and std::basic_string
+        * with the std::allocator. A container with another allocator may hold memory of an arena that dies.
+        */
+        template<typename T>
+        constexpr inline bool pool_recyclable = false;
+
+        template<typename T>
+        constexpr inline bool pool_recyclable<std::vector<T, std::allocator<T>>> = true;
+
+        template<typename C, typename Traits>
+        constexpr inline bool pool_recyclable<std::basic_string<C, Traits, std::allocator<C>>> = true;
+
+        constexpr auto recycling_active() noexcept -> bool {
+            return not std::is_constant_evaluated() and recycling;
+        }
+
+        /**
+        * An empty Cont from the pool, with room for n elements.
+        */
+        template<class Cont>
+        auto recycled_reserved(std::size_t n) -> Cont {
+            Cont ret = pool<Cont>::acquire();
+            ret.reserve(n);
+            return ret;
+        }
+
+        /**
+        * A Cont from the pool, holding n value-initialized elements.
+        */
+        template<class Cont>
+        auto recycled_sized(std::size_t n) -> Cont {
+            Cont ret = pool<Cont>::acquire();
+            ret.resize(n);
+            return ret;
+        }
+
+        /**
+        * Gives a spent intermediate back to the pool, unless it was passed on (moved from) by its stage.
+        */
+        template<typename In>
+        void recycle_spent(In &in) {
+            if constexpr (not std::is_lvalue_reference_v<In> and pool_recyclable<std::remove_cvref_t<In>>) {
+                if (in.capacity() != 0) {
+                    pool<std::remove_cvref_t<In>>::release(std::move(in));
+                }
+            }
+        }
+    }
+
+    /**
+    * Recycling is on, on the constructing thread, while this lives: the containers Map, Filter, Reject...
+    * would make (std::vector and std::basic_string with the std::allocator) come from fff::pool instead.
+    * Scopes nest.
+    * @see fff::recycling, which also gives the intermediate containers of a pipeline back to the pool
+    */
+    class ScopedRecycling {
+        bool previous;
+
+    public:
+        ScopedRecycling() noexcept : previous(std::exchange(liated::recycling, true)) {}
+
+        ScopedRecycling(const ScopedRecycling &) = delete;
+        ScopedRecycling &operator=(const ScopedRecycling &) = delete;
+
+        ~ScopedRecycling() {
+            liated::recycling = previous;
+        }
+    };
+
+    /**
+    * A Pipeline that runs with recycling on, and gives the containers between the stages back to the pool
+    * once the last stage is done, so that a later call gets them again, with their capacity.
+    * Called over and over with inputs of about the same size, it no longer allocates after the first calls.\n
+    * The result is the caller's; releasing it to fff::pool when done with it makes it part of the cycle too.
+    * @see fff::ScopedRecycling
+    */
+    template<class ...Fs>
+    class Recycling_f {
+        Pipeline<Fs...> pipeline;
+
+        /**
+        * Runs the stages from I on. The result of stage I goes back to the pool only once the stages after it
+        * have returned, as a temporary of a plain Pipeline lives to the end of the call: what a later stage gets,
+        * such as a std::span, may still refer to it.
+        */
+        template<std::size_t I, typename In>
+        auto next(In &&in) const -> decltype(auto) {
+            if constexpr (I + 1 == sizeof...(Fs)) {
+                return liated::call_stage(pipeline.template stage<I>(), std::forward<In>(in));
+            } else {
+                decltype(auto) out = liated::call_stage(pipeline.template stage<I>(), std::forward<In>(in));
+                decltype(auto) ret = next<I + 1>(std::forward<decltype(out)>(out));
+                liated::recycle_spent<decltype(out)>(out);
+                return ret;
+            }
+        }
+
+    public:
+        explicit Recycling_f(Pipeline<Fs...> pipeline) : pipeline(std::move(pipeline)) {}
+
+        template<class ...Args>
+            requires std::invocable<const Pipeline<Fs...> &, Args...>
+        auto operator()(Args &&...args) const -> decltype(auto) {
+            const ScopedRecycling scope;
+            if constexpr (sizeof...(Fs) == 1) {
+                return std::invoke(pipeline.template stage<0>(), std::forward<Args>(args)...);
+            } else {
+                decltype(auto) out = std::invoke(pipeline.template stage<0>(), std::forward<Args>(args)...);
+                decltype(auto) ret = next<1>(std::forward<decltype(out)>(out));
+                liated::recycle_spent<decltype(out)>(out);
+                return ret;
+            }
+        }
+
+        auto base() const noexcept -> const Pipeline<Fs...> & {
+            return pipeline;
+        }
+    };
+
+    struct RecyclingFactory {
+        template<class ...Fs>
+        auto operator()(Pipeline<Fs...> pipeline) const -> Recycling_f<Fs...> {
+            return Recycling_f<Fs...>(std::move(pipeline));
+        }
+    };
+
+    /**
+    * @example
+    * auto step = fff::recycling(fff::PipelineFactory()(
+    *     [](const std::vector\<Order> &in) {return fff::Filter()(in, valid);},
+    *     [](std::vector\<Order> &&in) {return fff::Map()(std::move(in), score);}));   // std::vector\<double>
+    * for (const auto &batch : batches) {
+    *     auto scores = step(batch);
+    *     publish(scores);
+    *     fff::pool<decltype(scores)>::release(std::move(scores));
+    * }
+    */
+    constexpr inline RecyclingFactory recycling;
+}
+
+#endif//UNDERSCORE_CPP_POOL_HPP
@@ -1,27 +1,27 @@
 #ifndef UNDERSCORE_CPP_PRACTICE_HPP
 #define UNDERSCORE_CPP_PRACTICE_HPP
 
-#include <mutex>
+#include <cstdint>
+
+#include "concurrency.hpp"
 
 namespace fff {
     /**
-     * This code is copied from cppreference.com
+     * The counter from cppreference.com's std::mutex example, without the mutex:
+     * inc() adds to the calling thread's stripe of a StripedCounter, get() sums the stripes.
      */
     class ThreadsafeCounter
     {
-        mutable std::mutex m; // The "M&M rule": mutable and mutex go together
-        int data = 0;
+        StripedCounter data;
     public:
-        int get() const
+        std::uint64_t get() const
         {
-            std::lock_guard<std::mutex> lk(m);
-            return data;
+            return data.load();
         }
 
         void inc()
         {
-            std::lock_guard<std::mutex> lk(m);
-            ++data;
+            data.add();
         }
     };
 }
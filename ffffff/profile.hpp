@@ -0,0 +1,489 @@
+#ifndef UNDERSCORE_CPP_PROFILE_HPP
+#define UNDERSCORE_CPP_PROFILE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "concurrency.hpp"
+#include "interfaces.hpp"
+#include "tmf.hpp"
+
+namespace fff::factory {
+    class Profiled;
+}
+
+/*
+* fff::LatencyHistogram fff::ProfileRegistry
+*/
+namespace fff {
+
+    /**
+    * What a LatencyHistogram holds, in nanoseconds.
+    */
+    struct LatencyStats {
+        std::uint64_t samples = 0;
+        std::uint64_t p50 = 0;
+        std::uint64_t p90 = 0;
+        std::uint64_t p99 = 0;
+        std::uint64_t p999 = 0;
+        std::uint64_t max = 0;
+        double mean = 0;
+    };
+
+    /**
+    * A histogram of latencies in the style of HdrHistogram. Values below 2^(precision + 1) have a bucket each,
+    * and every power of two above is split into 2^precision buckets, so a percentile is off by at most
+    * 1 / 2^precision of its value, from 1 ns up to 2^64 ns, in a fixed array of bucket_count counters.\n
+    * record() is one relaxed fetch_add on the bucket (plus a compare-exchange when it raises the maximum):
+    * it takes no lock and can be called from any number of threads.
+    * @warning threads recording the same latency share a counter; sample (see profile_options) a very hot stage
+    */
+    class LatencyHistogram {
+    public:
+        constexpr static unsigned precision = 5;
+
+        constexpr static std::size_t bucket_count =
+            (std::size_t{1} << (precision + 1)) + (63 - precision) * (std::size_t{1} << precision);
+
+        constexpr static auto bucket_of(std::uint64_t v) noexcept -> std::size_t {
+            if (v < (std::uint64_t{1} << (precision + 1))) {
+                return v;
+            }
+            const unsigned shift = static_cast<unsigned>(std::bit_width(v)) - 1 - precision;
+            return (std::size_t{1} << (precision + 1)) + (shift - 1) * (std::size_t{1} << precision)
+                + ((v >> shift) - (std::uint64_t{1} << precision));
+        }
+
+        /**
+        * The smallest and the largest value that fall into bucket b.
+        */
+        constexpr static auto lowest_of(std::size_t b) noexcept -> std::uint64_t {
+            if (b < (std::size_t{1} << (precision + 1))) {
+                return b;
+            }
+            const std::size_t i = b - (std::size_t{1} << (precision + 1));
+            return ((i & ((std::size_t{1} << precision) - 1)) + (std::uint64_t{1} << precision))
+                << (i / (std::size_t{1} << precision) + 1);
+        }
+
+        constexpr static auto highest_of(std::size_t b) noexcept -> std::uint64_t {
+            if (b + 1 == bucket_count) {
+                return UINT64_MAX;
+            }
+            return lowest_of(b + 1) - 1;
+        }
+
+    private:
+        std::unique_ptr<std::atomic<std::uint64_t>[]> buckets;
+        std::atomic<std::uint64_t> peak{0};
+
+    public:
+        LatencyHistogram() : buckets(new std::atomic<std::uint64_t>[bucket_count]) {
+            reset();
+        }
+
+        LatencyHistogram(const LatencyHistogram &) = delete;
+        LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+        void record(std::uint64_t ns) noexcept {
+            buckets[bucket_of(ns)].fetch_add(1, std::memory_order_relaxed);
+
+            std::uint64_t m = peak.load(std::memory_order_relaxed);
+            while (ns > m and not peak.compare_exchange_weak(m, ns, std::memory_order_relaxed)) {}
+        }
+
+    private:
+        auto load_counts(std::uint64_t &samples) const -> std::vector<std::uint64_t> {
+            std::vector<std::uint64_t> counts(bucket_count);
+            samples = 0;
+            for (std::size_t b = 0; b < bucket_count; ++b) {
+                counts[b] = buckets[b].load(std::memory_order_relaxed);
+                samples += counts[b];
+            }
+            return counts;
+        }
+
+        static auto value_at(const std::vector<std::uint64_t> &counts, std::uint64_t samples, std::uint64_t max,
+                             double q) noexcept -> std::uint64_t
+        {
+            const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(samples))));
+            std::uint64_t seen = 0;
+            for (std::size_t b = 0; b < bucket_count; ++b) {
+                seen += counts[b];
+                if (seen >= rank) {
+                    return std::min(highest_of(b), max);
+                }
+            }
+            return max;
+        }
+
+    public:
+        /**
+        * The percentiles are the largest value of the bucket they fall into, at most max.
+        * Recording while this runs gives a mix of before and after, as StripedCounter::load does.
+        */
+        auto stats() const -> LatencyStats {
+            LatencyStats s;
+            const auto counts = load_counts(s.samples);
+            if (s.samples == 0) {
+                return s;
+            }
+            s.max = peak.load(std::memory_order_relaxed);
+
+            double sum = 0;
+            for (std::size_t b = 0; b < bucket_count; ++b) {
+                sum += static_cast<double>(counts[b]) * (static_cast<double>(lowest_of(b)) + static_cast<double>(highest_of(b))) / 2;
+            }
+            s.mean = std::min(sum / static_cast<double>(s.samples), static_cast<double>(s.max));
+
+            s.p50 = value_at(counts, s.samples, s.max, 0.5);
+            s.p90 = value_at(counts, s.samples, s.max, 0.9);
+            s.p99 = value_at(counts, s.samples, s.max, 0.99);
+            s.p999 = value_at(counts, s.samples, s.max, 0.999);
+            return s;
+        }
+
+        /**
+        * The value below which a fraction q of the samples fall, e.g. percentile(0.99); 0 when there is none.
+        */
+        auto percentile(double q) const -> std::uint64_t {
+            std::uint64_t samples;
+            const auto counts = load_counts(samples);
+            return samples == 0 ? 0 : value_at(counts, samples, peak.load(std::memory_order_relaxed), q);
+        }
+
+        void reset() noexcept {
+            for (std::size_t b = 0; b < bucket_count; ++b) {
+                buckets[b].store(0, std::memory_order_relaxed);
+            }
+            peak.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    static_assert(LatencyHistogram::bucket_of(UINT64_MAX) == LatencyHistogram::bucket_count - 1);
+    static_assert(LatencyHistogram::bucket_of(LatencyHistogram::lowest_of(1000)) == 1000
+                  and LatencyHistogram::bucket_of(LatencyHistogram::highest_of(1000)) == 1000);
+
+    struct StageProfile {
+        std::string name;
+        LatencyStats stats;
+    };
+
+    /**
+    * The histograms of the named profiled stages, one per name: profiling two functions under one name
+    * records both into the same histogram. Looking a name up takes a lock, which happens when a profiled
+    * functor is made, never on a call.
+    */
+    class ProfileRegistry {
+        mutable std::mutex mtx;
+        std::vector<std::pair<std::string, std::shared_ptr<LatencyHistogram>>> entries;
+
+    public:
+        static auto global() -> ProfileRegistry & {
+            static ProfileRegistry registry;
+            return registry;
+        }
+
+        /**
+        * The histogram for name, made on first use.
+        */
+        auto histogram(std::string_view name) -> std::shared_ptr<LatencyHistogram> {
+            std::lock_guard lock(mtx);
+            for (const auto &[n, h] : entries) {
+                if (n == name) {
+                    return h;
+                }
+            }
+            return entries.emplace_back(std::string(name), std::make_shared<LatencyHistogram>()).second;
+        }
+
+        /**
+        * Every name with its statistics, in the order the names were first profiled
+        * (the arguments of one PipelineFactory call are made in an unspecified order).
+        */
+        auto report() const -> std::vector<StageProfile> {
+            std::lock_guard lock(mtx);
+            std::vector<StageProfile> out;
+            out.reserve(entries.size());
+            for (const auto &[n, h] : entries) {
+                out.push_back({n, h->stats()});
+            }
+            return out;
+        }
+
+        void reset() noexcept {
+            std::lock_guard lock(mtx);
+            for (const auto &e : entries) {
+                e.second->reset();
+            }
+        }
+    };
+
+    inline auto profile_report() -> std::vector<StageProfile> {
+        return ProfileRegistry::global().report();
+    }
+
+    /**
+    * Prints profile_report() as a table, one line per stage, latencies in nanoseconds.
+    */
+    inline void print_profile(std::ostream &os = std::cout) {
+        const auto report = profile_report();
+
+        std::size_t width = 5;
+        for (const auto &s : report) {
+            width = std::max(width, s.name.size());
+        }
+
+        os << std::left << std::setw(static_cast<int>(width)) << "stage" << std::right
+           << std::setw(12) << "samples" << std::setw(10) << "mean" << std::setw(10) << "p50"
+           << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(12) << "max" << '\n';
+        for (const auto &[name, s] : report) {
+            os << std::left << std::setw(static_cast<int>(width)) << name << std::right
+               << std::setw(12) << s.samples << std::setw(10) << static_cast<std::uint64_t>(s.mean)
+               << std::setw(10) << s.p50 << std::setw(10) << s.p90 << std::setw(10) << s.p99
+               << std::setw(10) << s.p999 << std::setw(12) << s.max << '\n';
+        }
+    }
+}
+
+/*
+* fff::Profiled_f Reducible_TD
+*/
+namespace fff {
+
+    enum class profile_clock {
+        steady,     // std::chrono::steady_clock
+        tsc,        // the time stamp counter (rdtsc), steady_clock where there is none
+    };
+
+    struct profile_options {
+        /**
+        * Times one call out of sample_period on average (rounded up to a power of two), chosen at random,
+        * so a stage called every few nanoseconds pays for a clock read only now and then.
+        * The histogram then holds the samples, not every call.
+        */
+        std::uint32_t sample_period = 1;
+
+        /**
+        * @warning tsc assumes an invariant TSC (constant_tsc and nonstop_tsc in /proc/cpuinfo)
+        */
+        profile_clock clock = profile_clock::steady;
+    };
+
+    namespace liated {
+
+        inline auto steady_ns() noexcept -> std::uint64_t {
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+        /**
+        * Nanoseconds per TSC tick, measured against steady_clock over a millisecond on first use.
+        * Profiled_f calls it when it is made, so that no timed call waits for the measurement.
+        */
+        inline auto tsc_ns_per_tick() noexcept -> double {
+            static const double ratio = [] {
+                const std::uint64_t t0 = steady_ns();
+                const std::uint64_t c0 = __rdtsc();
+                std::uint64_t t1 = t0;
+                while (t1 - t0 < 1'000'000) {
+                    t1 = steady_ns();
+                }
+                const std::uint64_t c1 = __rdtsc();
+                return c1 == c0 ? 1.0 : static_cast<double>(t1 - t0) / static_cast<double>(c1 - c0);
+            }();
+            return ratio;
+        }
+#endif
+
+        inline auto clock_now(profile_clock clock) noexcept -> std::uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+            if (clock == profile_clock::tsc) {
+                return __rdtsc();
+            }
+#endif
+            return steady_ns();
+        }
+
+        /**
+        * Does the one-time setup of clock (the TSC calibration) now rather than while timing a call.
+        */
+        inline void prepare_clock([[maybe_unused]] profile_clock clock) noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+            if (clock == profile_clock::tsc) {
+                static_cast<void>(tsc_ns_per_tick());
+            }
+#endif
+        }
+
+        inline auto elapsed_ns(profile_clock clock, std::uint64_t from, std::uint64_t to) noexcept -> std::uint64_t {
+#if defined(__x86_64__) || defined(__i386__)
+            if (clock == profile_clock::tsc) {
+                return static_cast<std::uint64_t>(static_cast<double>(to - from) * tsc_ns_per_tick());
+            }
+#endif
+            return to - from;
+        }
+
+        /**
+        * A per-thread xorshift, so sampling neither shares a counter between threads
+        * nor lines up with the order the stages of a pipeline are called in.
+        */
+        inline auto sampled(std::uint64_t mask) noexcept -> bool {
+            if (mask == 0) {
+                return true;
+            }
+            thread_local std::uint64_t s = 0x9E3779B97F4A7C15ull ^ ((thread_slot() + 1) * 0xBF58476D1CE4E5B9ull);
+            s ^= s << 13;
+            s ^= s >> 7;
+            s ^= s << 17;
+            return (s & mask) == 0;
+        }
+
+        /**
+        * Records the time from its construction to its destruction, so a call that throws is timed too.
+        */
+        class LatencyScope {
+            LatencyHistogram &hist;
+            profile_clock clock;
+            std::uint64_t start;
+
+        public:
+            LatencyScope(LatencyHistogram &hist, profile_clock clock) noexcept
+                : hist(hist), clock(clock), start(clock_now(clock)) {}
+
+            LatencyScope(const LatencyScope &) = delete;
+            LatencyScope &operator=(const LatencyScope &) = delete;
+
+            ~LatencyScope() {
+                hist.record(elapsed_ns(clock, start, clock_now(clock)));
+            }
+        };
+    }
+
+    /**
+    * Calls f and records how long the call took into a LatencyHistogram.
+    * Copies of the functor share the histogram, as ConcurrentCount_f shares its counter.
+    * @see fff::profiled
+    */
+    template<class F>
+    class Profiled_f : public callable_i<F, Profiled_f<F>, std::invoke_result> {
+        friend callable_i<F, Profiled_f<F>, std::invoke_result>;
+        friend factory::Profiled;
+
+        [[no_unique_address]] F f;
+        std::shared_ptr<LatencyHistogram> hist;
+        std::uint64_t sample_mask;
+        profile_clock clock;
+
+        Profiled_f(const F &f, std::shared_ptr<LatencyHistogram> hist, const profile_options &opt)
+            : f(f), hist(std::move(hist)), sample_mask(std::bit_ceil(std::max<std::uint32_t>(1, opt.sample_period)) - 1),
+              clock(opt.clock)
+        {
+            liated::prepare_clock(clock);
+        }
+        Profiled_f(F &&f, std::shared_ptr<LatencyHistogram> hist, const profile_options &opt)
+            : f(std::move(f)), hist(std::move(hist)), sample_mask(std::bit_ceil(std::max<std::uint32_t>(1, opt.sample_period)) - 1),
+              clock(opt.clock)
+        {
+            liated::prepare_clock(clock);
+        }
+
+        template<similar<Profiled_f> Self, typename ...Args>
+        static auto call_impl(Self &&self, Args &&...args)
+            noexcept(std::is_nothrow_invocable_v<F, Args...>)
+                -> std::invoke_result_t<F, Args...>
+        {
+            if (not liated::sampled(self.sample_mask)) {
+                return std::invoke(std::forward<Self>(self).f, std::forward<Args>(args)...);
+            }
+            liated::LatencyScope scope(*self.hist, self.clock);
+            return std::invoke(std::forward<Self>(self).f, std::forward<Args>(args)...);
+        }
+
+    public:
+        auto histogram() const noexcept -> const LatencyHistogram & {
+            return *hist;
+        }
+
+        auto stats() const -> LatencyStats {
+            return hist->stats();
+        }
+    };
+
+    namespace factory {
+        struct Profiled {
+#ifdef FFF_DISABLE_PROFILING
+            template<class F>
+            constexpr auto operator()(std::string_view, F &&f, const profile_options & = {}) const
+                -> std::decay_t<F>
+            {
+                return std::forward<F>(f);
+            }
+
+            template<class F>
+                requires (not std::convertible_to<F, std::string_view>)
+            constexpr auto operator()(F &&f, const profile_options & = {}) const
+                -> std::decay_t<F>
+            {
+                return std::forward<F>(f);
+            }
+#else
+            /**
+            * Records into the histogram ProfileRegistry::global() keeps for name.
+            */
+            template<class F>
+            auto operator()(std::string_view name, F &&f, const profile_options &opt = {}) const
+                -> Profiled_f<std::decay_t<F>>
+            {
+                return Profiled_f<std::decay_t<F>>(std::forward<F>(f), ProfileRegistry::global().histogram(name), opt);
+            }
+
+            /**
+            * Records into a histogram of its own, read through stats().
+            */
+            template<class F>
+                requires (not std::convertible_to<F, std::string_view>)
+            auto operator()(F &&f, const profile_options &opt = {}) const
+                -> Profiled_f<std::decay_t<F>>
+            {
+                return Profiled_f<std::decay_t<F>>(std::forward<F>(f), std::make_shared<LatencyHistogram>(), opt);
+            }
+#endif
+        };
+    }
+
+    /**
+    * Wraps a function so every call (or one call out of profile_options::sample_period) is timed.
+    * Naming the stages of a Pipeline gives the latency of each stage of the chain in profile_report().
+    * Defining FFF_DISABLE_PROFILING makes profiled(...) return the function itself, so the wrapper costs nothing
+    * and can stay in the code (profile_report() is then empty).
+    * @example
+    * auto chain = fff::PipelineFactory()(fff::profiled("parse", parse), fff::profiled("score", score));
+    * for (auto &&line : lines) chain(line);
+    * fff::print_profile();     // samples, mean, p50, p90, p99, p99.9 and max of parse and of score
+    */
+    constexpr inline factory::Profiled profiled;
+}
+
+#endif//UNDERSCORE_CPP_PROFILE_HPP
@@ -0,0 +1,332 @@
+#ifndef UNDERSCORE_CPP_RECORDS_HPP
+#define UNDERSCORE_CPP_RECORDS_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+* fff::MappedRecords fff::ChunkedReader : files of fixed-size records, as ranges the functors take
+*/
+namespace fff {
+
+    /**
+    * How a MappedRecords is going to be read, passed on to the kernel with madvise().
+    * sequential reads ahead more, and drops the pages behind the reader sooner.
+    */
+    enum class record_access {
+        normal,
+        sequential,
+        random,
+    };
+
+    namespace liated {
+
+        /**
+        * A file descriptor, closed when this goes out of scope.
+        */
+        class FileHandle {
+            int fd = -1;
+
+        public:
+            FileHandle(const std::filesystem::path &path, const char *who) : fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+                if (fd < 0) {
+                    throw std::system_error(errno, std::generic_category(), who);
+                }
+            }
+
+            FileHandle(const FileHandle &) = delete;
+            FileHandle &operator=(const FileHandle &) = delete;
+
+            ~FileHandle() {
+                ::close(fd);
+            }
+
+            auto get() const noexcept -> int {
+                return fd;
+            }
+
+            auto size(const char *who) const -> std::size_t {
+                struct ::stat st{};
+                if (::fstat(fd, &st) != 0) {
+                    throw std::system_error(errno, std::generic_category(), who);
+                }
+                return static_cast<std::size_t>(st.st_size);
+            }
+        };
+    }
+
+    /**
+    * A file of T records, mapped read-only into memory: a contiguous, sized range of const T that Map, Filter,
+    * Each, Some... take like a std::vector, in one pass and without reading the file into one first.
+    * The pages are read in as they are touched, and the kernel can drop them again, so a file larger than
+    * the memory works. Map and Filter collect their results into a std::vector.\n
+    * Bytes past the last whole record are not part of the range.
+    * @example
+    * fff::MappedRecords<Trade> trades("trades.bin");
+    * auto large = fff::Filter()(trades, [](const Trade &t) {return t.qty > 1000;});   // std::vector<Trade>
+    * @throw std::system_error if the file cannot be opened or mapped
+    */
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    class MappedRecords {
+        void *base = nullptr;
+        std::size_t length = 0;
+
+        static void unmap(void *p, std::size_t n) noexcept {
+            if (p != nullptr) {
+                ::munmap(p, n);
+            }
+        }
+
+    public:
+        constexpr static bool is_record_source = true;
+
+        using value_type = T;
+        using size_type = std::size_t;
+        using const_iterator = const T *;
+        using iterator = const_iterator;
+
+        explicit MappedRecords(const std::filesystem::path &path, record_access access = record_access::sequential) {
+            const liated::FileHandle file(path, "fff::MappedRecords");
+            length = file.size("fff::MappedRecords");
+            if (length < sizeof(T)) {
+                length = 0;
+                return;
+            }
+
+            base = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file.get(), 0);
+            if (base == MAP_FAILED) {
+                base = nullptr;
+                throw std::system_error(errno, std::generic_category(), "fff::MappedRecords");
+            }
+
+            if (access != record_access::normal) {
+                ::madvise(base, length, access == record_access::sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+            }
+        }
+
+        MappedRecords(MappedRecords &&other) noexcept
+            : base(std::exchange(other.base, nullptr)), length(std::exchange(other.length, 0)) {}
+
+        MappedRecords &operator=(MappedRecords &&other) noexcept {
+            if (this != &other) {
+                unmap(base, length);
+                base = std::exchange(other.base, nullptr);
+                length = std::exchange(other.length, 0);
+            }
+            return *this;
+        }
+
+        ~MappedRecords() {
+            unmap(base, length);
+        }
+
+        auto data() const noexcept -> const T * {
+            return static_cast<const T *>(base);
+        }
+
+        auto size() const noexcept -> std::size_t {
+            return length / sizeof(T);
+        }
+
+        auto empty() const noexcept -> bool {
+            return size() == 0;
+        }
+
+        auto begin() const noexcept -> const T * {
+            return data();
+        }
+
+        auto end() const noexcept -> const T * {
+            return data() + size();
+        }
+
+        auto operator[](std::size_t i) const noexcept -> const T & {
+            return data()[i];
+        }
+
+        /**
+        * Asks the kernel to start reading records [first, first + n) in, ahead of their use.
+        */
+        void prefetch(std::size_t first, std::size_t n) const noexcept {
+            if (first >= size()) {
+                return;
+            }
+            n = std::min(n, size() - first);
+
+            const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            const std::size_t from = first * sizeof(T) / page * page;
+            ::madvise(static_cast<char *>(base) + from, (first + n) * sizeof(T) - from, MADV_WILLNEED);
+        }
+
+        auto records() const noexcept -> std::span<const T> {
+            return {data(), size()};
+        }
+    };
+
+    /**
+    * How a ChunkedReader reads.
+    * @member chunk_records the records read at once: the reader holds one chunk in memory
+    * @member chunks_ahead how many chunks past the current one the kernel is asked to read in (posix_fadvise)
+    */
+    struct chunked_options {
+        std::size_t chunk_records = std::size_t(1) << 16;
+        std::size_t chunks_ahead = 2;
+    };
+
+    /**
+    * A file (or pipe) of T records, read chunk by chunk with read(): an input range of const T that
+    * Map, Filter, Each, Some... take in one pass, with one chunk of memory whatever the size of the file.
+    * Before every read, the kernel is asked to read the next chunks ahead, so that the reads find them cached.\n
+    * The range is single pass: begin() goes on from where the last iteration stopped.
+    * Bytes past the last whole record are not part of the range.
+    * @example
+    * fff::ChunkedReader<Trade> trades("trades.bin");
+    * const bool any = fff::some(trades, [](const Trade &t) {return t.qty > 1000;});   // stops reading there
+    * @throw std::system_error if the file cannot be opened, and from the iteration if a read fails
+    */
+    template<typename T>
+        requires std::is_trivially_copyable_v<T>
+    class ChunkedReader {
+        struct State {
+            liated::FileHandle file;
+            chunked_options options;
+            std::vector<T> chunk;
+            std::size_t count = 0;  // records in chunk
+            std::size_t pos = 0;
+            off_t offset = 0;
+            bool done = false;
+            bool stale = false;  // the chunk was handed out by next_chunk()
+
+            State(const std::filesystem::path &path, const chunked_options &opt)
+                : file(path, "fff::ChunkedReader"), options(opt)
+            {
+                options.chunk_records = std::max<std::size_t>(1, options.chunk_records);
+                chunk.resize(options.chunk_records);
+                ::posix_fadvise(file.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+                refill();
+            }
+
+            /**
+            * Reads the next chunk; count is 0 at the end of the file.
+            */
+            void refill() {
+                const std::size_t bytes = options.chunk_records * sizeof(T);
+                if (options.chunks_ahead != 0) {
+                    ::posix_fadvise(file.get(), offset + static_cast<off_t>(bytes),
+                                    static_cast<off_t>(bytes * options.chunks_ahead), POSIX_FADV_WILLNEED);
+                }
+
+                auto *out = reinterpret_cast<char *>(chunk.data());
+                std::size_t got = 0;
+                while (got < bytes) {
+                    const ::ssize_t n = ::read(file.get(), out + got, bytes - got);
+                    if (n < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        throw std::system_error(errno, std::generic_category(), "fff::ChunkedReader");
+                    }
+                    if (n == 0) {
+                        break;
+                    }
+                    got += static_cast<std::size_t>(n);
+                }
+
+                offset += static_cast<off_t>(got);
+                count = got / sizeof(T);
+                pos = 0;
+                done = count == 0;
+                stale = false;
+            }
+
+            void advance() {
+                if (++pos == count) {
+                    refill();
+                }
+            }
+        };
+
+        std::unique_ptr<State> state;
+
+    public:
+        constexpr static bool is_record_source = true;
+
+        using value_type = T;
+
+        class iterator {
+            State *s = nullptr;
+
+        public:
+            using iterator_concept = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+            explicit iterator(State *s) noexcept : s(s) {}
+
+            auto operator*() const noexcept -> const T & {
+                return s->chunk[s->pos];
+            }
+
+            auto operator++() -> iterator & {
+                s->advance();
+                return *this;
+            }
+
+            void operator++(int) {
+                ++*this;
+            }
+
+            friend auto operator==(const iterator &it, std::default_sentinel_t) noexcept -> bool {
+                return it.s->done;
+            }
+        };
+
+        explicit ChunkedReader(const std::filesystem::path &path, chunked_options options = {})
+            : state(std::make_unique<State>(path, options)) {}
+
+        /**
+        * The records of the chunk in hand that were not iterated over yet: empty at the end of the file.
+        * The span is valid until the next call (or begin()), which reads the next chunk into the same memory.
+        * For loops that work a chunk at a time, e.g. Map with a parallel policy on each chunk.
+        */
+        auto next_chunk() -> std::span<const T> {
+            if (state->stale) {
+                state->refill();
+            }
+            if (state->done) {
+                return {};
+            }
+            state->stale = true;
+            return {state->chunk.data() + state->pos, state->count - state->pos};
+        }
+
+        auto begin() const -> iterator {
+            if (state->stale) {
+                state->refill();
+            }
+            return iterator(state.get());
+        }
+
+        auto end() const noexcept -> std::default_sentinel_t {
+            return std::default_sentinel;
+        }
+    };
+}
+
+#endif//UNDERSCORE_CPP_RECORDS_HPP
@@ -1,20 +1,188 @@
 #ifndef UNDERSCORE_CPP_REDUCIBLE_HPP
 #define UNDERSCORE_CPP_REDUCIBLE_HPP
 
+#include "basic_ops.hpp"
+#include "execution.hpp"
 #include "interfaces.hpp"
+#include "simd.hpp"
 #include "tmf.hpp"
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <vector>
 
 namespace fff::factory {
     class Reducible;
+    class Associative;
+    class Commutative;
+}
+
+/*
+* fff::associative, fff::commutative : declaring the algebra of a binary operator
+*/
+namespace fff {
+
+    /**
+    * Wraps a binary operator and declares it associative, and optionally commutative.
+    * Reductions may then regroup (tree order, parallel chunks) and, if commutative, reorder the operands.
+    * @tparam F the binary operator
+    * @tparam Commutative whether the operands may also be swapped
+    */
+    template<typename F, bool Commutative>
+    class Associative_f {
+        friend factory::Associative;
+        friend factory::Commutative;
+
+        [[no_unique_address]] F f;
+
+        constexpr explicit Associative_f(const F &f) noexcept : f(f) {}
+        constexpr explicit Associative_f(F &&f) noexcept : f(std::move(f)) {}
+
+    public:
+        using function_type = F;
+
+        constexpr static bool associative = true;
+        constexpr static bool commutative = Commutative;
+
+        template<typename ...Args>
+            requires std::invocable<const F &, Args...>
+        constexpr auto operator()(Args &&...args) const
+            noexcept(std::is_nothrow_invocable_v<const F &, Args...>)
+                -> std::invoke_result_t<const F &, Args...>
+        {
+            return std::invoke(f, std::forward<Args>(args)...);
+        }
+
+        constexpr auto base() const noexcept -> const F & {
+            return f;
+        }
+    };
+
+    namespace factory {
+        struct Associative {
+            template<typename F>
+            constexpr auto operator()(F &&f) const noexcept
+                -> Associative_f<std::decay_t<F>, false>
+            {
+                return Associative_f<std::decay_t<F>, false>{std::forward<F>(f)};
+            }
+        };
+
+        struct Commutative {
+            template<typename F>
+            constexpr auto operator()(F &&f) const noexcept
+                -> Associative_f<std::decay_t<F>, true>
+            {
+                return Associative_f<std::decay_t<F>, true>{std::forward<F>(f)};
+            }
+        };
+    }
+
+    /**
+    * Declares f associative: fff::associative(std::plus<>())
+    */
+    constexpr inline factory::Associative associative;
+
+    /**
+    * Declares f associative AND commutative. (Commutativity alone allows no reordering in a reduction.)
+    */
+    constexpr inline factory::Commutative commutative;
+
+    /**
+    * Whether F is known to be associative.
+    * True for the operators wrapped by fff::associative/commutative, and for the standard arithmetic and
+    * bitwise operators, fff::minimum and fff::maximum. Specialize it to declare your own types.
+    */
+    template<typename F>
+    struct is_associative : std::bool_constant<requires { requires F::associative; }> {};
+
+    template<typename F>
+    struct is_commutative : std::bool_constant<requires { requires F::commutative; }> {};
+
+    template<typename T> struct is_associative<std::plus<T>> : std::true_type {};
+    template<typename T> struct is_associative<std::multiplies<T>> : std::true_type {};
+    template<typename T> struct is_associative<std::bit_and<T>> : std::true_type {};
+    template<typename T> struct is_associative<std::bit_or<T>> : std::true_type {};
+    template<typename T> struct is_associative<std::bit_xor<T>> : std::true_type {};
+    template<> struct is_associative<minimum_f> : std::true_type {};
+    template<> struct is_associative<maximum_f> : std::true_type {};
+
+    template<typename F>
+    constexpr inline bool is_associative_v = is_associative<std::remove_cvref_t<F>>::value;
+
+    template<typename F>
+    constexpr inline bool is_commutative_v = is_commutative<std::remove_cvref_t<F>>::value;
+}
+
+namespace fff::liated {
+
+    /**
+    * The operator without its Associative_f wrapper, used to find a SIMD kernel for it.
+    */
+    template<typename F>
+    constexpr auto unwrap_op(const F &f) noexcept -> const F & {
+        return f;
+    }
+
+    template<typename F, bool C>
+    constexpr auto unwrap_op(const Associative_f<F, C> &f) noexcept -> const F & {
+        return f.base();
+    }
+
+    /**
+    * Below this many elements, tree_reduce() stops splitting and runs a plain loop (or a SIMD kernel).
+    */
+    constexpr inline std::size_t pairwise_leaf = 128;
+
+    /**
+    * Reduces the n >= 1 elements from first in pairwise (tree) order:
+    * every half is reduced on its own and the two results are combined.
+    * The dependency chain is O(log n) long instead of O(n), and floating-point error grows the same way.
+    */
+    template<typename T, std::random_access_iterator It, typename Op>
+    constexpr auto tree_reduce(It first, std::size_t n, const Op &op) -> T {
+        if (n <= pairwise_leaf) {
+            using Base = std::remove_cvref_t<decltype(unwrap_op(op))>;
+
+            if constexpr (std::contiguous_iterator<It>
+                          and std::is_same_v<std::iter_value_t<It>, T>
+                          and simd::reduction_op<Base, T>) {
+                if (not std::is_constant_evaluated()) {
+                    const T *p = std::to_address(first);
+                    return simd::reduce(std::span<const T>(p + 1, n - 1), unwrap_op(op), *p);
+                }
+            }
+
+            T acc = *first;
+            for (std::size_t i = 1; i < n; ++i) {
+                acc = std::invoke(op, std::move(acc), first[i]);
+            }
+
+            return acc;
+        }
+
+        const std::size_t half = n / 2;
+        return std::invoke(op, tree_reduce<T>(first, half, op), tree_reduce<T>(first + half, n - half, op));
+    }
+
+    template<typename R>
+    concept tree_reducible_range = std::ranges::random_access_range<R> and std::ranges::sized_range<R>;
 }
 
 namespace fff {
 
     namespace liated {
-        template<typename F, typename Arg_1, typename Arg_2, typename ...Args>
+        template<typename F, typename Arg_1, typename ...Args>
         struct Reducible_TD;
 
+        template<typename F, std::ranges::input_range R>
+        struct Reducible_TD<F, R> {
+            using type = std::ranges::range_value_t<R>;
+        };
+
         template<typename F, typename Arg_1, typename Arg_2>
         struct Reducible_TD<F, Arg_1, Arg_2> {
             using type = std::invoke_result_t<F, Arg_1, Arg_2>;
@@ -22,12 +190,44 @@ namespace fff {
             constexpr static bool nothrow = std::is_nothrow_invocable_v<F, Arg_1, Arg_2>;
         };
 
-        template<typename F, typename Arg_1, typename Arg_2, typename ...Args>
-        struct Reducible_TD {
-            using type = typename Reducible_TD<
-                F, std::invoke_result_t<F, Arg_1, Arg_2>, Args...
-                >::type;
+        /**
+        * fold_type\<F, A> ->* std::type_identity\<B> is fold_type\<F, F(A, B)>, declared only,
+        * so the result of a left fold is one fold expression in decltype instead of one instantiation per argument.
+        */
+        template<typename F, typename A>
+        struct fold_type {
+            using type = A;
+        };
+
+        template<typename F, typename A, typename B>
+        auto operator->*(fold_type<F, A>, std::type_identity<B>) noexcept
+            -> fold_type<F, std::invoke_result_t<F, A, B>>;
+
+        template<typename F, typename Arg_1, typename Arg_2, typename Arg_3, typename ...Args>
+        struct Reducible_TD<F, Arg_1, Arg_2, Arg_3, Args...> {
+            using type = typename decltype(
+                ((fold_type<F, std::invoke_result_t<F, Arg_1, Arg_2>>() ->* std::type_identity<Arg_3>())
+                    ->* ... ->* std::type_identity<Args>())
+                )::type;
+        };
+
+        /**
+        * The same fold on values: Folding{f, acc} ->* b is Folding{f, f(acc, b)}.
+        */
+        template<typename Fn, typename A>
+        struct Folding {
+            Fn &f;
+            A acc;
         };
+
+        template<typename Fn, typename A, typename B>
+            requires std::invocable<Fn &, A, B>
+        constexpr auto operator->*(Folding<Fn, A> &&l, B &&b)
+            noexcept(std::is_nothrow_invocable_v<Fn &, A, B>)
+                -> Folding<Fn, std::invoke_result_t<Fn &, A, B>>
+        {
+            return {l.f, std::invoke(l.f, std::forward<A>(l.acc), std::forward<B>(b))};
+        }
     }
 
     template<typename F>
@@ -41,6 +241,39 @@ namespace fff {
         constexpr explicit Reducible_f(const F &f) noexcept : f(f) {}
         constexpr explicit Reducible_f(F &&f) noexcept : f(std::move(f)) {}
 
+        /**
+        * Reduces a whole range, as in reducible(std::plus<>())(vec).
+        * Folds from the first element; an empty range gives a value-initialized T.\n
+        * Associative operators (see is_associative) over random-access ranges are reduced in tree order.
+        * Contiguous ranges of arithmetic values reduced by +, *, fff::minimum or fff::maximum
+        * go through simd::reduce.
+        */
+        template<typename Self, std::ranges::input_range R>
+        constexpr static auto call_impl(Self &&self, R &&r)
+            -> std::ranges::range_value_t<R>
+        {
+            using T = std::ranges::range_value_t<R>;
+
+            if constexpr (is_associative_v<F> and liated::tree_reducible_range<R>) {
+                const std::size_t n = std::ranges::size(r);
+                return n == 0 ? T() : liated::tree_reduce<T>(std::ranges::begin(r), n, self.f);
+            }
+
+            auto it = std::ranges::begin(r);
+            const auto end = std::ranges::end(r);
+
+            if (it == end) {
+                return T();
+            }
+
+            T acc = *it;
+            for (++it; it != end; ++it) {
+                acc = std::invoke(self.f, std::move(acc), *it);
+            }
+
+            return acc;
+        }
+
         template<typename Self, typename T1, typename T2>
         constexpr static auto call_impl(Self &&self, T1 &&t1, T2 &&t2)
             noexcept(std::is_nothrow_invocable_v<F, T1, T2>)
@@ -51,6 +284,23 @@ namespace fff {
                                std::forward<T2>(t2));
         }
 
+        /**
+        * Associative operators on arguments of one type are folded as a balanced tree,
+        * f(f(a, b), f(c, d)) instead of f(f(f(a, b), c), d), so independent calls can overlap.
+        */
+        template<std::size_t Lo, std::size_t Hi, typename Self, typename Tuple>
+        constexpr static decltype(auto) balanced_fold(Self &&self, Tuple &&args)
+        {
+            if constexpr (Hi - Lo == 1) {
+                return std::get<Lo>(std::forward<Tuple>(args));
+            } else {
+                constexpr std::size_t Mid = Lo + (Hi - Lo) / 2;
+                return std::invoke(self.f,
+                                   balanced_fold<Lo, Mid>(self, std::forward<Tuple>(args)),
+                                   balanced_fold<Mid, Hi>(self, std::forward<Tuple>(args)));
+            }
+        }
+
         // @todo Determine noexcept condition
 
         template<typename Self, typename T1, typename T2, typename ...Args>
@@ -58,12 +308,29 @@ namespace fff {
             noexcept
                 -> typename liated::Reducible_TD<F, T1, T2, Args...>::type
         {
-            return call_impl(self,
-                             std::invoke(self.f,
-                                         std::forward<T1>(t1),
-                                         std::forward<T2>(t2)),
-                             args...);
+            if constexpr (is_associative_v<F>
+                          and similar<T1, T2> and (similar<T1, Args> and ...)) {
+                return balanced_fold<0, 2 + sizeof...(Args)>(
+                    self, std::forward_as_tuple(std::forward<T1>(t1), std::forward<T2>(t2), std::forward<Args>(args)...));
+            } else {
+                using Fn = std::remove_reference_t<decltype((self.f))>;
+                using A = std::invoke_result_t<Fn &, T1, T2>;
+
+                return (liated::Folding<Fn, A>{self.f, std::invoke(self.f, std::forward<T1>(t1), std::forward<T2>(t2))}
+                        ->* ... ->* std::forward<Args>(args)).acc;
+            }
         }
+
+    public:
+        /**
+        * reduce(range, init) with this operator.
+        * @see fff::reduce
+        */
+        template<std::ranges::input_range R, typename T>
+        constexpr auto reduce(R &&r, T init) const -> T;
+
+        template<execution_policy Policy, std::ranges::input_range R, typename T>
+        auto reduce(const Policy &policy, R &&r, T init) const -> T;
     };
 
     namespace factory {
@@ -80,4 +347,92 @@ namespace fff {
     constexpr inline factory::Reducible reducible;
 }
 
+/*
+* fff::reduce
+*/
+namespace fff {
+
+    namespace fs {
+        struct Reduce_f {
+            /**
+            * Reduces r into init with op.
+            * Associative operators (see is_associative) over random-access ranges are evaluated in tree order,
+            * anything else is folded from left to right.
+            * @return op(init, reduction of r), or init if r is empty
+            */
+            template<std::ranges::input_range R, typename Op, typename T>
+            constexpr auto operator()(R &&r, const Op &op, T init) const -> T
+            {
+                if constexpr (is_associative_v<Op> and liated::tree_reducible_range<R>) {
+                    const std::size_t n = std::ranges::size(r);
+                    if (n == 0) {
+                        return init;
+                    }
+                    return std::invoke(op, std::move(init), liated::tree_reduce<T>(std::ranges::begin(r), n, op));
+                } else {
+                    for (auto &&v : r) {
+                        init = std::invoke(op, std::move(init), std::forward<decltype(v)>(v));
+                    }
+                    return init;
+                }
+            }
+
+            /**
+            * Multi-threaded reduce. The chunks are reduced in parallel, each in tree order.
+            * The partial results are combined in input order, unless op is commutative
+            * (fff::commutative): then every thread folds its chunks straight into its own partial result,
+            * in whatever order it claims them.
+            * @warning op must be associative; declare it with fff::associative if it is not a built-in one
+            */
+            template<execution_policy Policy, std::ranges::input_range R, typename Op, typename T>
+            auto operator()(const Policy &policy, R &&r, const Op &op, T init) const -> T
+            {
+                if constexpr (parallel_execution_policy<Policy> and liated::tree_reducible_range<R>) {
+                    static_assert(is_associative_v<Op>,
+                                  "fff::reduce : a parallel reduction needs an associative operator (fff::associative)");
+
+                    const auto plan = liated::plan_chunks(policy, std::ranges::size(r));
+                    const auto first = std::ranges::begin(r);
+
+                    std::vector<std::optional<T>> partial(is_commutative_v<Op> ? liated::thread_count(plan) : plan.count);
+
+                    liated::parallel_chunks(plan, [&](std::size_t b, std::size_t e, std::size_t c, std::size_t w) {
+                        T v = liated::tree_reduce<T>(first + b, e - b, op);
+                        auto &slot = partial[is_commutative_v<Op> ? w : c];
+
+                        if (slot) {
+                            *slot = std::invoke(op, std::move(*slot), std::move(v));
+                        } else {
+                            slot.emplace(std::move(v));
+                        }
+                    });
+
+                    for (auto &p : partial) {
+                        if (p) {
+                            init = std::invoke(op, std::move(init), std::move(*p));
+                        }
+                    }
+                    return init;
+                } else {
+                    return operator()(std::forward<R>(r), op, std::move(init));
+                }
+            }
+        };
+    }
+
+    constexpr inline fs::Reduce_f reduce;
+
+    template<typename F>
+    template<std::ranges::input_range R, typename T>
+    constexpr auto Reducible_f<F>::reduce(R &&r, T init) const -> T {
+        return fff::reduce(std::forward<R>(r), f, std::move(init));
+    }
+
+    template<typename F>
+    template<execution_policy Policy, std::ranges::input_range R, typename T>
+    auto Reducible_f<F>::reduce(const Policy &policy, R &&r, T init) const -> T {
+        return fff::reduce(policy, std::forward<R>(r), f, std::move(init));
+    }
+}
+
 #endif//UNDERSCORE_CPP_REDUCIBLE_HPP
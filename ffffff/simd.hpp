@@ -0,0 +1,193 @@
+#ifndef UNDERSCORE_CPP_SIMD_HPP
+#define UNDERSCORE_CPP_SIMD_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#endif
+
+#include "basic_ops.hpp"
+#include "classify.h"
+
+/*
+* fff::simd : explicit SIMD kernels for contiguous ranges of arithmetic values
+*/
+namespace fff {
+
+    namespace simd {
+
+        /**
+        * The value types the kernels handle: every arithmetic type except bool.
+        */
+        template<typename T>
+        concept lane_type = arithmetic<T> and not std::is_same_v<std::remove_cv_t<T>, bool>;
+
+        /**
+        * f, marked as working lane by lane: called with a native\<T> (every lane at once), it returns
+        * what calling it on each lane would. Map and batched only vectorize functions marked so,
+        * since a generic lambda is not known to be valid for native\<T> until its body is instantiated.
+        */
+        template<class F>
+        struct Lanewise_f {
+            F f;
+
+            constexpr static bool is_lanewise = true;
+
+            template<class ...Args>
+                requires std::invocable<const F &, Args...>
+            constexpr auto operator()(Args &&...args) const
+                noexcept(std::is_nothrow_invocable_v<const F &, Args...>)
+                    -> std::invoke_result_t<const F &, Args...>
+            {
+                return std::invoke(f, std::forward<Args>(args)...);
+            }
+        };
+
+        struct LanewiseFactory {
+            template<class F>
+            constexpr auto operator()(F &&f) const -> Lanewise_f<std::decay_t<F>> {
+                return Lanewise_f<std::decay_t<F>>{std::forward<F>(f)};
+            }
+        };
+
+        /**
+        * @example fff::Map()(samples, fff::simd::lanewise([](auto x) {return x * 2 + 1;}))
+        */
+        constexpr inline LanewiseFactory lanewise;
+
+        template<typename F>
+        concept lanewise_marked = requires {
+            requires std::remove_cvref_t<F>::is_lanewise;
+        };
+
+#if __has_include(<experimental/simd>)
+        /**
+        * The widest register the target supports (SSE, AVX2, AVX-512, NEON...).
+        * The width is fixed when the translation unit is compiled, so build with -march to get the wide ones.
+        */
+        template<lane_type T>
+        using native = std::experimental::native_simd<T>;
+
+        constexpr inline bool enabled = true;
+
+        /**
+        * Determines whether f can be run lane by lane: f must be marked with simd::lanewise,
+        * and map T to T and native\<T> to native\<T>. Nothing is instantiated with native\<T> for an unmarked f.
+        */
+        template<typename F, typename T>
+        concept vectorizable = lane_type<T>
+            and lanewise_marked<F>
+            and std::is_same_v<std::invoke_result_t<const F &, T>, T>
+            and requires (const F &f, native<T> v) {
+                { f(v) } -> std::same_as<native<T>>;
+            };
+#else
+        constexpr inline bool enabled = false;
+
+        template<typename F, typename T>
+        concept vectorizable = false;
+#endif
+
+        namespace liated {
+            template<typename Op, typename T>
+            constexpr bool op_is = std::is_same_v<std::remove_cvref_t<Op>, T>;
+        }
+
+        /**
+        * The binary operators that have a SIMD reduction kernel.
+        */
+        template<typename Op, typename T>
+        concept reduction_op = lane_type<T>
+            and (liated::op_is<Op, std::plus<>> or liated::op_is<Op, std::plus<T>>
+                 or liated::op_is<Op, std::multiplies<>> or liated::op_is<Op, std::multiplies<T>>
+                 or liated::op_is<Op, minimum_f> or liated::op_is<Op, maximum_f>);
+
+        /**
+        * A contiguous, sized range of lane_type values, the kind of range the kernels run on.
+        */
+        template<typename R>
+        concept lane_range = std::ranges::contiguous_range<R>
+            and std::ranges::sized_range<R>
+            and lane_type<std::ranges::range_value_t<R>>;
+
+        /**
+        * out[i] = f(in[i]) for every i, one register at a time. The tail is done with scalar calls.
+        * @warning out must have at least in.size() elements
+        */
+        template<lane_type T, vectorizable<T> F>
+        void transform(std::span<const T> in, std::span<T> out, const F &f) noexcept {
+            const std::size_t n = in.size();
+            std::size_t i = 0;
+
+            if constexpr (enabled) {
+                constexpr std::size_t W = native<T>::size();
+                for (; i + W <= n; i += W) {
+                    f(native<T>(in.data() + i, std::experimental::element_aligned))
+                        .copy_to(out.data() + i, std::experimental::element_aligned);
+                }
+            }
+
+            for (; i < n; ++i) {
+                out[i] = f(in[i]);
+            }
+        }
+
+        /**
+        * Folds in with op, starting from init. The lanes are accumulated separately and combined at the end,
+        * so for floating-point values the result may differ from a left-to-right loop in the last bits.
+        */
+        template<lane_type T, reduction_op<T> Op>
+        auto reduce(std::span<const T> in, const Op &op, T init) noexcept -> T {
+            const std::size_t n = in.size();
+            std::size_t i = 0;
+
+            if constexpr (enabled) {
+                namespace stdx = std::experimental;
+                constexpr std::size_t W = native<T>::size();
+
+                if (n >= W) {
+                    native<T> acc(in.data(), stdx::element_aligned);
+
+                    for (i = W; i + W <= n; i += W) {
+                        const native<T> v(in.data() + i, stdx::element_aligned);
+
+                        if constexpr (liated::op_is<Op, minimum_f>) {
+                            acc = stdx::min(acc, v);
+                        } else if constexpr (liated::op_is<Op, maximum_f>) {
+                            acc = stdx::max(acc, v);
+                        } else if constexpr (liated::op_is<Op, std::multiplies<>> or liated::op_is<Op, std::multiplies<T>>) {
+                            acc *= v;
+                        } else {
+                            acc += v;
+                        }
+                    }
+
+                    if constexpr (liated::op_is<Op, minimum_f>) {
+                        init = static_cast<T>(op(init, stdx::hmin(acc)));
+                    } else if constexpr (liated::op_is<Op, maximum_f>) {
+                        init = static_cast<T>(op(init, stdx::hmax(acc)));
+                    } else if constexpr (liated::op_is<Op, std::multiplies<>> or liated::op_is<Op, std::multiplies<T>>) {
+                        init = static_cast<T>(op(init, stdx::reduce(acc, std::multiplies<>())));
+                    } else {
+                        init = static_cast<T>(op(init, stdx::reduce(acc)));
+                    }
+                }
+            }
+
+            for (; i < n; ++i) {
+                init = static_cast<T>(op(init, in[i]));
+            }
+
+            return init;
+        }
+    }
+}
+
+#endif//UNDERSCORE_CPP_SIMD_HPP
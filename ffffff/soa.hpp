@@ -0,0 +1,452 @@
+#ifndef UNDERSCORE_CPP_SOA_HPP
+#define UNDERSCORE_CPP_SOA_HPP
+
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "tmf.hpp"
+
+/*
+* fff::soa_vector fff::soa_selection fff::columns
+*/
+namespace fff {
+
+    /**
+    * A row of a soa_vector: a tuple of references into its columns (Refs are Field & or const Field &).
+    * Being a std::tuple, it goes wherever lambdas written for tuples go: std::get\<I>(row), structured bindings,
+    * a parameter const std::tuple\<Fields...> & (copying the row). Only the columns that are read are touched.
+    */
+    template<class ...Refs>
+    class soa_ref : public std::tuple<Refs...> {
+    public:
+        using std::tuple<Refs...>::tuple;
+        using std::tuple<Refs...>::operator=;
+
+        template<std::size_t I>
+        constexpr auto get() const noexcept -> nth_among<I, Refs...> {
+            return std::get<I>(static_cast<const std::tuple<Refs...> &>(*this));
+        }
+    };
+
+    template<class ...Fields>
+        requires (sizeof...(Fields) > 0)
+    class soa_vector;
+
+    template<class Soa>
+    class soa_selection;
+
+    namespace liated {
+
+        /**
+        * The random-access iterator of a soa_vector or a soa_selection: a position, dereferenced into a soa_ref.
+        */
+        template<class Owner, class Ref>
+        class SoaIterator {
+            Owner *owner = nullptr;
+            std::ptrdiff_t pos = 0;
+
+        public:
+            using iterator_concept = std::random_access_iterator_tag;
+            using iterator_category = std::input_iterator_tag;
+            using value_type = typename std::remove_const_t<Owner>::value_type;
+            using difference_type = std::ptrdiff_t;
+            using reference = Ref;
+
+            constexpr SoaIterator() = default;
+            constexpr SoaIterator(Owner *owner, std::ptrdiff_t pos) noexcept : owner(owner), pos(pos) {}
+
+            constexpr auto operator*() const -> Ref {return (*owner)[static_cast<std::size_t>(pos)];}
+            constexpr auto operator[](difference_type n) const -> Ref {return (*owner)[static_cast<std::size_t>(pos + n)];}
+
+            constexpr auto operator++() noexcept -> SoaIterator & {++pos; return *this;}
+            constexpr auto operator--() noexcept -> SoaIterator & {--pos; return *this;}
+            constexpr auto operator++(int) noexcept -> SoaIterator {auto t = *this; ++pos; return t;}
+            constexpr auto operator--(int) noexcept -> SoaIterator {auto t = *this; --pos; return t;}
+            constexpr auto operator+=(difference_type n) noexcept -> SoaIterator & {pos += n; return *this;}
+            constexpr auto operator-=(difference_type n) noexcept -> SoaIterator & {pos -= n; return *this;}
+
+            friend constexpr auto operator+(SoaIterator it, difference_type n) noexcept -> SoaIterator {return it += n;}
+            friend constexpr auto operator+(difference_type n, SoaIterator it) noexcept -> SoaIterator {return it += n;}
+            friend constexpr auto operator-(SoaIterator it, difference_type n) noexcept -> SoaIterator {return it -= n;}
+            friend constexpr auto operator-(const SoaIterator &a, const SoaIterator &b) noexcept -> difference_type {
+                return a.pos - b.pos;
+            }
+
+            friend constexpr auto operator==(const SoaIterator &a, const SoaIterator &b) noexcept -> bool {
+                return a.pos == b.pos;
+            }
+            friend constexpr auto operator<=>(const SoaIterator &a, const SoaIterator &b) noexcept {
+                return a.pos <=> b.pos;
+            }
+        };
+
+        /**
+        * The column of a bool field: a contiguous array of real bools, where std::vector\<bool> would pack bits
+        * that soa_ref cannot bind to (bool &) and that std::span\<bool> cannot view.
+        */
+        class BoolColumn {
+            bool *ptr = nullptr;
+            std::size_t n = 0;
+            std::size_t cap = 0;
+
+        public:
+            using value_type = bool;
+            using size_type = std::size_t;
+            using iterator = bool *;
+            using const_iterator = const bool *;
+
+            constexpr BoolColumn() = default;
+
+            constexpr explicit BoolColumn(std::size_t n) {
+                resize(n);
+            }
+
+            constexpr BoolColumn(const BoolColumn &other) {
+                reserve(other.n);
+                std::copy(other.ptr, other.ptr + other.n, ptr);
+                n = other.n;
+            }
+
+            constexpr BoolColumn(BoolColumn &&other) noexcept
+                : ptr(std::exchange(other.ptr, nullptr)), n(std::exchange(other.n, 0)), cap(std::exchange(other.cap, 0))
+            {}
+
+            constexpr auto operator=(BoolColumn other) noexcept -> BoolColumn & {
+                std::swap(ptr, other.ptr);
+                std::swap(n, other.n);
+                std::swap(cap, other.cap);
+                return *this;
+            }
+
+            constexpr ~BoolColumn() {
+                if (ptr) {
+                    std::allocator<bool>().deallocate(ptr, cap);
+                }
+            }
+
+            constexpr auto size() const noexcept -> std::size_t {return n;}
+            constexpr auto empty() const noexcept -> bool {return n == 0;}
+            constexpr auto capacity() const noexcept -> std::size_t {return cap;}
+
+            constexpr void reserve(std::size_t m) {
+                if (m <= cap) {
+                    return;
+                }
+                bool *p = std::allocator<bool>().allocate(m);
+                for (std::size_t i = 0; i < m; ++i) {
+                    std::construct_at(p + i, i < n and ptr[i]);
+                }
+                if (ptr) {
+                    std::allocator<bool>().deallocate(ptr, cap);
+                }
+                ptr = p;
+                cap = m;
+            }
+
+            constexpr void resize(std::size_t m) {
+                reserve(m);
+                std::fill(ptr + std::min(n, m), ptr + m, false);
+                n = m;
+            }
+
+            constexpr void clear() noexcept {
+                n = 0;
+            }
+
+            template<typename U>
+                requires std::constructible_from<bool, U>
+            constexpr void emplace_back(U &&u) {
+                const bool v = static_cast<bool>(std::forward<U>(u));
+                if (n == cap) {
+                    reserve(cap == 0 ? 8 : 2 * cap);
+                }
+                ptr[n++] = v;
+            }
+
+            constexpr void push_back(bool v) {
+                emplace_back(v);
+            }
+
+            constexpr auto operator[](std::size_t k) noexcept -> bool & {return ptr[k];}
+            constexpr auto operator[](std::size_t k) const noexcept -> const bool & {return ptr[k];}
+
+            constexpr auto data() noexcept -> bool * {return ptr;}
+            constexpr auto data() const noexcept -> const bool * {return ptr;}
+
+            constexpr auto begin() noexcept -> bool * {return ptr;}
+            constexpr auto end() noexcept -> bool * {return ptr + n;}
+            constexpr auto begin() const noexcept -> const bool * {return ptr;}
+            constexpr auto end() const noexcept -> const bool * {return ptr + n;}
+        };
+
+        /**
+        * The storage of a field of a soa_vector: a std::vector, or a BoolColumn for bool.
+        */
+        template<typename Field>
+        using soa_column_t = std::conditional_t<std::is_same_v<Field, bool>, BoolColumn, std::vector<Field>>;
+    }
+
+    /**
+    * A vector of rows (Fields...) stored as one contiguous std::vector per field, so a pass that reads one field
+    * only brings in the cache lines of that field.\n
+    * Rows are soa_ref proxies. Map, Filter and fff::reduce work on it as on any range; with a stage that says
+    * which columns it reads (fff::columns), Map and Filter walk those columns only, and Filter returns the
+    * indices of the rows it keeps (a soa_selection) instead of copying them.
+    * A bool field is stored as real bools (liated::BoolColumn), not as the bits of a std::vector\<bool>.
+    * @example
+    * fff::soa_vector<std::uint64_t, double, std::uint32_t> trades;     // id, price, qty
+    * auto big = fff::Filter()(trades, fff::columns<2>([](std::uint32_t q) {return q > 1000;}));
+    * double notional = fff::reduce(fff::Map()(big, fff::columns<1, 2>(std::multiplies<>())), std::plus<>(), 0.0);
+    */
+    template<class ...Fields>
+        requires (sizeof...(Fields) > 0)
+    class soa_vector {
+        std::tuple<liated::soa_column_t<Fields>...> cols;
+
+        template<class Self, std::size_t ...I>
+        constexpr static auto row(Self &self, std::size_t k, std::index_sequence<I...>) noexcept {
+            using R = std::conditional_t<std::is_const_v<Self>, soa_ref<const Fields &...>, soa_ref<Fields &...>>;
+            return R(std::get<I>(self.cols)[k]...);
+        }
+
+        constexpr static auto indices() noexcept {
+            return std::index_sequence_for<Fields...>();
+        }
+
+    public:
+        constexpr static bool is_soa = true;
+
+        using value_type = std::tuple<Fields...>;
+        using reference = soa_ref<Fields &...>;
+        using const_reference = soa_ref<const Fields &...>;
+        using size_type = std::size_t;
+        using iterator = liated::SoaIterator<soa_vector, reference>;
+        using const_iterator = liated::SoaIterator<const soa_vector, const_reference>;
+
+        constexpr soa_vector() = default;
+
+        constexpr explicit soa_vector(std::size_t n) : cols(liated::soa_column_t<Fields>(n)...) {}
+
+        constexpr auto size() const noexcept -> std::size_t {return std::get<0>(cols).size();}
+        constexpr auto empty() const noexcept -> bool {return size() == 0;}
+
+        constexpr void reserve(std::size_t n) {
+            std::apply([n](auto &...c) {(c.reserve(n), ...);}, cols);
+        }
+
+        constexpr void resize(std::size_t n) {
+            std::apply([n](auto &...c) {(c.resize(n), ...);}, cols);
+        }
+
+        constexpr void clear() noexcept {
+            std::apply([](auto &...c) {(c.clear(), ...);}, cols);
+        }
+
+        template<class ...Args>
+            requires (sizeof...(Args) == sizeof...(Fields))
+        constexpr void emplace_back(Args &&...args) {
+            [&]<std::size_t ...I>(std::index_sequence<I...>) {
+                (std::get<I>(cols).emplace_back(std::forward<Args>(args)), ...);
+            }(indices());
+        }
+
+        /**
+        * Appends a row: a std::tuple, or a soa_ref of this or of another soa_vector.
+        */
+        template<class ...Ts>
+            requires (sizeof...(Ts) == sizeof...(Fields))
+        constexpr void push_back(const std::tuple<Ts...> &row) {
+            std::apply([this](const auto &...v) {emplace_back(v...);}, row);
+        }
+
+        constexpr auto operator[](std::size_t k) noexcept -> reference {return row(*this, k, indices());}
+        constexpr auto operator[](std::size_t k) const noexcept -> const_reference {return row(*this, k, indices());}
+
+        constexpr auto begin() noexcept -> iterator {return {this, 0};}
+        constexpr auto end() noexcept -> iterator {return {this, static_cast<std::ptrdiff_t>(size())};}
+        constexpr auto begin() const noexcept -> const_iterator {return {this, 0};}
+        constexpr auto end() const noexcept -> const_iterator {return {this, static_cast<std::ptrdiff_t>(size())};}
+
+        /**
+        * The I-th field of every row, contiguous: reduce(v.column\<1>(), std::plus<>(), 0.0) reads only that field.
+        */
+        template<std::size_t I>
+        constexpr auto column() const noexcept -> const liated::soa_column_t<nth_among<I, Fields...>> & {
+            return std::get<I>(cols);
+        }
+
+        /**
+        * The same, writable. The column cannot be resized from here, so that every column keeps the same size.
+        */
+        template<std::size_t I>
+        constexpr auto column() noexcept -> std::span<nth_among<I, Fields...>> {
+            return std::get<I>(cols);
+        }
+    };
+
+    /**
+    * Some rows of a soa_vector, by index, as Filter returns them: nothing is copied.
+    * Map, Filter and fff::reduce take it like the soa_vector, reading only the rows it holds.
+    * @warning refers to the soa_vector, which must outlive it and not be resized meanwhile
+    */
+    template<class Soa>
+    class soa_selection {
+        const Soa *src;
+        std::vector<std::size_t> idx;
+
+    public:
+        constexpr static bool is_soa = true;
+        constexpr static bool is_soa_selection = true;
+
+        using source_type = Soa;
+        using value_type = typename Soa::value_type;
+        using const_reference = typename Soa::const_reference;
+        using reference = const_reference;
+        using size_type = std::size_t;
+        using iterator = liated::SoaIterator<const soa_selection, const_reference>;
+        using const_iterator = iterator;
+
+        constexpr soa_selection(const Soa &src, std::vector<std::size_t> rows) noexcept
+            : src(&src), idx(std::move(rows)) {}
+
+        constexpr auto size() const noexcept -> std::size_t {return idx.size();}
+        constexpr auto empty() const noexcept -> bool {return idx.empty();}
+
+        constexpr auto operator[](std::size_t k) const noexcept -> const_reference {return (*src)[idx[k]];}
+
+        constexpr auto begin() const noexcept -> iterator {return {this, 0};}
+        constexpr auto end() const noexcept -> iterator {return {this, static_cast<std::ptrdiff_t>(size())}; }
+
+        /**
+        * The indices in source() of the selected rows, increasing.
+        */
+        constexpr auto rows() const noexcept -> const std::vector<std::size_t> & {return idx;}
+        constexpr auto source() const noexcept -> const Soa & {return *src;}
+
+        /**
+        * The I-th field of the selected rows, gathered as they are read: a random-access view.
+        */
+        template<std::size_t I>
+        constexpr auto column() const noexcept {
+            return idx | std::views::transform([col = &src->template column<I>()](std::size_t r) -> decltype(auto) {
+                return (*col)[r];
+            });
+        }
+
+        /**
+        * The selected rows, copied into a soa_vector of their own.
+        */
+        constexpr auto materialize() const -> Soa {
+            Soa out;
+            out.reserve(idx.size());
+            for (std::size_t r : idx) {
+                out.push_back((*src)[r]);
+            }
+            return out;
+        }
+    };
+
+    /**
+    * f, reading the columns I... of a row: f(std::get\<I>(row)...).
+    * On a soa_vector, Map and Filter hand f those columns straight from their storage and skip the others.
+    */
+    template<class F, std::size_t ...I>
+    class Columns_f {
+        [[no_unique_address]] F f;
+
+    public:
+        constexpr explicit Columns_f(const F &f) : f(f) {}
+        constexpr explicit Columns_f(F &&f) noexcept : f(std::move(f)) {}
+
+        template<class Row>
+            requires std::invocable<const F &, decltype(std::get<I>(std::declval<const Row &>()))...>
+        constexpr auto operator()(const Row &row) const
+            noexcept(std::is_nothrow_invocable_v<const F &, decltype(std::get<I>(std::declval<const Row &>()))...>)
+                -> decltype(auto)
+        {
+            return std::invoke(f, std::get<I>(row)...);
+        }
+
+        constexpr static std::size_t first = [] {
+            const std::size_t is[] = {I..., 0};
+            return is[0];
+        }();
+
+        constexpr auto base() const noexcept -> const F & {
+            return f;
+        }
+
+        /**
+        * f on row r of src, read from the columns I... of src and no other.
+        */
+        template<class Soa>
+        constexpr auto at(const Soa &src, std::size_t r) const -> decltype(auto) {
+            return std::invoke(f, src.template column<I>()[r]...);
+        }
+    };
+
+    namespace liated {
+        template<class F>
+        struct column_stage : std::false_type {};
+
+        template<class F, std::size_t ...I>
+        struct column_stage<Columns_f<F, I...>> : std::true_type {};
+
+        template<class F>
+        struct single_column_stage : std::false_type {};
+
+        template<class F, std::size_t I>
+        struct single_column_stage<Columns_f<F, I>> : std::true_type {};
+    }
+
+    template<std::size_t ...I>
+    struct ColumnsFactory {
+        template<class F>
+        constexpr auto operator()(F &&f) const -> Columns_f<std::decay_t<F>, I...> {
+            return Columns_f<std::decay_t<F>, I...>(std::forward<F>(f));
+        }
+    };
+
+    /**
+    * @example fff::columns<1, 2>(std::multiplies<>())   // row -> price * qty
+    */
+    template<std::size_t ...I>
+    constexpr inline ColumnsFactory<I...> columns;
+}
+
+template<class ...Refs>
+struct std::tuple_size<fff::soa_ref<Refs...>> : std::integral_constant<std::size_t, sizeof...(Refs)> {};
+
+template<std::size_t I, class ...Refs>
+struct std::tuple_element<I, fff::soa_ref<Refs...>> {
+    using type = fff::nth_among<I, Refs...>;
+};
+
+/**
+* A row and a std::tuple of values have the values as their common reference, so the iterators of soa_vector
+* are random-access iterators (std::indirectly_readable) even though they return proxies.
+*/
+template<class ...Refs, class ...Ts, template<class> class RQual, template<class> class TQual>
+    requires (sizeof...(Refs) == sizeof...(Ts))
+struct std::basic_common_reference<fff::soa_ref<Refs...>, std::tuple<Ts...>, RQual, TQual> {
+    using type = std::tuple<Ts...>;
+};
+
+template<class ...Ts, class ...Refs, template<class> class TQual, template<class> class RQual>
+    requires (sizeof...(Refs) == sizeof...(Ts))
+struct std::basic_common_reference<std::tuple<Ts...>, fff::soa_ref<Refs...>, TQual, RQual> {
+    using type = std::tuple<Ts...>;
+};
+
+#endif//UNDERSCORE_CPP_SOA_HPP
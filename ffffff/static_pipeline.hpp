@@ -0,0 +1,339 @@
+#ifndef UNDERSCORE_CPP_STATIC_PIPELINE_HPP
+#define UNDERSCORE_CPP_STATIC_PIPELINE_HPP
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "basic_ops.hpp"
+#include "bind.hpp"
+#include "pipeline.hpp"
+#include "tmf.hpp"
+
+/*
+* fff::Affine_f fff::add fff::multiply
+*/
+namespace fff {
+
+    /**
+    * x * M + A, with both constants in the type: add\<C> and multiply\<C> are affine stages too,
+    * so that a StaticPipeline can fold a run of them into one.
+    */
+    template<auto M, auto A>
+        requires std::same_as<decltype(M), decltype(A)>
+    struct Affine_f {
+        using coefficient_type = decltype(M);
+
+        constexpr static coefficient_type multiplier = M;
+        constexpr static coefficient_type offset = A;
+
+        template<typename T>
+            requires requires (const T &x) {x * M + A;}
+        constexpr auto operator()(const T &x) const noexcept(noexcept(x * M + A))
+            -> decltype(x * M + A)
+        {
+            if constexpr (std::is_arithmetic_v<T> and M == 1) {
+                return x + A;
+            } else if constexpr (std::is_arithmetic_v<T> and A == 0) {
+                return x * M;
+            } else {
+                return x * M + A;
+            }
+        }
+    };
+
+    template<auto M, auto A>
+    constexpr inline Affine_f<M, A> affine;
+
+    /**
+    * A run of affine stages Parts... folded into the one affine stage Folded. Only an integral argument goes
+    * through Folded: integer arithmetic gives the same result in either order, but floating-point arithmetic
+    * rounds at every step, so any other argument goes through Parts... one after the other.
+    */
+    template<class Folded, class ...Parts>
+    struct FoldedAffine_f {
+        using folded_type = Folded;
+
+        template<typename T>
+            requires std::invocable<const Folded &, const T &>
+        constexpr auto operator()(const T &x) const noexcept(std::is_nothrow_invocable_v<const Folded &, const T &>) {
+            if constexpr (std::integral<T>) {
+                return Folded()(x);
+            } else {
+                return run<Parts...>(x);
+            }
+        }
+
+    private:
+        template<class P, class ...Ps, typename T>
+        constexpr static auto run(const T &x) {
+            if constexpr (sizeof...(Ps) == 0) {
+                return P()(x);
+            } else {
+                return run<Ps...>(P()(x));
+            }
+        }
+    };
+
+    template<auto C>
+    constexpr inline Affine_f<static_cast<decltype(C)>(1), C> add;
+
+    template<auto C>
+    constexpr inline Affine_f<C, static_cast<decltype(C)>(0)> multiply;
+}
+
+/*
+* fff::StaticPipeline
+*/
+namespace fff {
+
+    template<class ...Fs>
+    class StaticPipeline;
+
+    namespace liated {
+
+        /**
+        * A stage with no state of its own, other than an empty class: a Static_L_Bind_f or Static_R_Bind_f
+        * of a stateless function, whose bound values are in the type.
+        */
+        template<typename S>
+        struct stateless : std::bool_constant<std::is_empty_v<S>> {};
+
+        template<typename F, class ...ValueHolders>
+        struct stateless<Static_L_Bind_f<F, ValueHolders...>> : stateless<F> {};
+
+        template<typename F, class ...ValueHolders>
+        struct stateless<Static_R_Bind_f<F, ValueHolders...>> : stateless<F> {};
+
+        template<typename S>
+        struct is_affine : std::false_type {};
+
+        template<auto M, auto A>
+        struct is_affine<Affine_f<M, A>> : std::true_type {};
+
+        template<class Folded, class ...Parts>
+        struct is_affine<FoldedAffine_f<Folded, Parts...>> : std::true_type {};
+
+        /**
+        * Whether (x * M1 + A1) * M2 + A2 can be computed as x * (M1 * M2) + (A1 * M2 + A2) with the same result:
+        * integral constants of one type that does not promote (so the products are computed in that type),
+        * and no overflow in the new constants.
+        */
+        template<class F, class G>
+        constexpr inline bool affine_foldable = false;
+
+        template<auto M1, auto A1, auto M2, auto A2>
+        constexpr inline bool affine_foldable<Affine_f<M1, A1>, Affine_f<M2, A2>> = [] {
+            using T = decltype(M1);
+            if constexpr (not std::same_as<T, decltype(M2)> or not std::integral<T>
+                          or not std::same_as<decltype(M1 * M2), T>) {
+                return false;
+            } else {
+                T m, a, c;
+                return not __builtin_mul_overflow(M1, M2, &m)
+                    and not __builtin_mul_overflow(A1, M2, &a)
+                    and not __builtin_add_overflow(a, A2, &c);
+            }
+        }();
+
+        template<class Folded, class ...Parts, class G>
+        constexpr inline bool affine_foldable<FoldedAffine_f<Folded, Parts...>, G> = affine_foldable<Folded, G>;
+
+        template<class F, class G>
+        struct affine_constants;
+
+        template<auto M1, auto A1, auto M2, auto A2>
+        struct affine_constants<Affine_f<M1, A1>, Affine_f<M2, A2>> {
+            using type = Affine_f<static_cast<decltype(M1)>(M1 * M2), static_cast<decltype(M1)>(A1 * M2 + A2)>;
+        };
+
+        /**
+        * The stage F >> G folds into, which keeps F and G to run them one after the other on non-integral arguments.
+        */
+        template<class F, class G>
+        struct affine_fold {
+            using type = FoldedAffine_f<typename affine_constants<F, G>::type, F, G>;
+        };
+
+        template<class Folded, class ...Parts, class G>
+        struct affine_fold<FoldedAffine_f<Folded, Parts...>, G> {
+            using type = FoldedAffine_f<typename affine_constants<Folded, G>::type, Parts..., G>;
+        };
+
+        template<typename S>
+        constexpr inline bool is_identity = std::same_as<S, Identity>;
+
+        template<auto M, auto A>
+        constexpr inline bool is_identity<Affine_f<M, A>> = std::integral<decltype(M)> and M == 1 and A == 0;
+
+        template<class ...Fs, std::size_t ...I>
+        consteval auto drop_last(std::index_sequence<I...>) noexcept
+            -> std::type_identity<StaticPipeline<nth_among<I, Fs...>...>>
+        {
+            return {};
+        }
+
+        /**
+        * The type of StaticPipeline\<Fs...> >> G: a foldable affine G merges into the affine stage before it,
+        * an identity is dropped, and a no_op after affine stages only leaves the no_op.
+        */
+        template<class ...Fs, class G>
+        consteval auto append_stage(std::type_identity<StaticPipeline<Fs...>>, std::type_identity<G>) noexcept {
+            if constexpr (is_identity<G>) {
+                return std::type_identity<StaticPipeline<Fs...>>();
+            } else if constexpr (std::same_as<G, no_op_f> and (is_affine<Fs>::value and ...)) {
+                return std::type_identity<StaticPipeline<no_op_f>>();
+            } else if constexpr (sizeof...(Fs) > 0) {
+                using Last = nth_among<sizeof...(Fs) - 1, Fs...>;
+                if constexpr (affine_foldable<Last, G>) {
+                    return append_stage(drop_last<Fs...>(std::make_index_sequence<sizeof...(Fs) - 1>()),
+                                        std::type_identity<typename affine_fold<Last, G>::type>());
+                } else {
+                    return std::type_identity<StaticPipeline<Fs..., G>>();
+                }
+            } else {
+                return std::type_identity<StaticPipeline<G>>();
+            }
+        }
+
+        template<class P, class G>
+        using append_stage_t = typename decltype(append_stage(std::type_identity<P>(), std::type_identity<G>()))::type;
+
+        /**
+        * A one-byte integral input (not bool) is looked up in a table of all 256 results, made at compile time,
+        * when the stages can be evaluated at compile time and do more than one affine step.
+        */
+        template<typename T, class ...Fs>
+        concept tabulated_input = std::integral<T> and sizeof(T) == 1 and (not std::same_as<T, bool>)
+            and (sizeof...(Fs) > 1 or (not is_affine<Fs>::value and ...))
+            and std::invocable<const Pipeline<Fs...> &, const T &>
+            and (std::is_arithmetic_v<std::invoke_result_t<const Pipeline<Fs...> &, const T &>>
+                 or std::is_enum_v<std::invoke_result_t<const Pipeline<Fs...> &, const T &>>)
+            and requires {
+                typename std::bool_constant<(static_cast<void>(Pipeline<Fs...>(Fs()...)(T())), true)>;
+            };
+    }
+
+    /**
+    * A stage of a StaticPipeline: it carries no state, so the stage can be made again from its type.
+    */
+    template<typename S>
+    concept static_stage = std::default_initializable<S> and std::is_trivially_copyable_v<S>
+        and liated::stateless<S>::value;
+
+    /**
+    * A pipeline of stateless stages put together at compile time with >>: add<3> >> multiply<5> is
+    * StaticPipeline\<FoldedAffine_f\<Affine_f\<5, 15>, ...>>, a single stage that computes x * 5 + 15 for an integral x,
+    * and (x + 3) * 5 otherwise; Identity (and add<0>, multiply<1>) leave the type as it is.
+    * When the input is a one-byte integer, the whole chain is a lookup in a table made at compile time.
+    * Otherwise a call is a Pipeline of the stages, which the compiler inlines since they have no state.
+    * @example
+    * constexpr auto scale = fff::add<3> >> fff::multiply<5> >> fff::static_l_bind<7>(std::minus<>());
+    * static_assert(std::same_as<decltype(scale), const fff::StaticPipeline\<fff::FoldedAffine_f\<fff::Affine_f\<5, 15>, ...>, ...>>);
+    * @warning affine stages are folded for integral constants only, and the folded stage is used for integral
+    * arguments only: for floating-point ones, folding would round differently
+    */
+    template<class ...Fs>
+    class StaticPipeline {
+        static_assert((static_stage<Fs> and ...), "fff::StaticPipeline : every stage must be a static_stage");
+
+        template<typename T>
+        constexpr static auto make_table() noexcept {
+            std::array<std::invoke_result_t<const Pipeline<Fs...> &, const T &>, 256> table{};
+            for (std::size_t i = 0; i < table.size(); ++i) {
+                table[i] = Pipeline<Fs...>(Fs()...)(static_cast<T>(static_cast<unsigned char>(i)));
+            }
+            return table;
+        }
+
+        template<typename T>
+        constexpr static auto table = make_table<T>();
+
+        template<typename T>
+        constexpr static auto call_one(T &&t)
+            noexcept(std::is_nothrow_invocable_v<const Pipeline<Fs...> &, T>)
+                -> std::invoke_result_t<const Pipeline<Fs...> &, T>
+        {
+            if constexpr (liated::tabulated_input<std::remove_cvref_t<T>, Fs...>) {
+                if (not std::is_constant_evaluated()) {
+                    return table<std::remove_cvref_t<T>>[static_cast<unsigned char>(t)];
+                }
+            }
+            return Pipeline<Fs...>(Fs()...)(std::forward<T>(t));
+        }
+
+    public:
+        constexpr static std::size_t size = sizeof...(Fs);
+
+        template<typename T>
+            requires (sizeof...(Fs) == 0)
+        constexpr auto operator()(T &&t) const noexcept(std::is_nothrow_constructible_v<std::remove_cvref_t<T>, T>)
+            -> std::remove_cvref_t<T>
+        {
+            return std::forward<T>(t);
+        }
+
+        template<class ...Args>
+            requires (sizeof...(Fs) > 0)
+        constexpr auto operator()(Args &&...args) const
+            noexcept(std::is_nothrow_invocable_v<const Pipeline<Fs...> &, Args...>)
+                -> std::invoke_result_t<const Pipeline<Fs...> &, Args...>
+        {
+            if constexpr (sizeof...(Args) == 1) {
+                return call_one(std::forward<Args>(args)...);
+            } else {
+                return Pipeline<Fs...>(Fs()...)(std::forward<Args>(args)...);
+            }
+        }
+
+        /**
+        * The same stages as a Pipeline, e.g. to go on with stages that have state.
+        */
+        constexpr auto to_pipeline() const noexcept -> Pipeline<Fs...> requires (sizeof...(Fs) > 0) {
+            return Pipeline<Fs...>(Fs()...);
+        }
+    };
+
+    constexpr inline StaticPipeline<> static_pipeline;
+
+    template<class ...Fs, static_stage G>
+    constexpr auto operator>>(StaticPipeline<Fs...>, G) noexcept
+        -> liated::append_stage_t<StaticPipeline<Fs...>, G>
+    {
+        return {};
+    }
+
+    namespace liated {
+        /**
+        * G as stages to append one by one: a folded affine stage goes back to the stages it was folded from,
+        * so that they fold with the ones before them.
+        */
+        template<class G>
+        constexpr auto unfolded(G g) noexcept {
+            return g;
+        }
+
+        template<class Folded, class ...Parts>
+        constexpr auto unfolded(FoldedAffine_f<Folded, Parts...>) noexcept {
+            return StaticPipeline<Parts...>();
+        }
+    }
+
+    template<class ...Fs, class ...Gs>
+    constexpr auto operator>>(StaticPipeline<Fs...> p, StaticPipeline<Gs...>) noexcept {
+        return (p >> ... >> liated::unfolded(Gs()));
+    }
+
+    template<auto M, auto A, static_stage G>
+    constexpr auto operator>>(Affine_f<M, A>, G) noexcept
+        -> liated::append_stage_t<liated::append_stage_t<StaticPipeline<>, Affine_f<M, A>>, G>
+    {
+        return {};
+    }
+}
+
+#endif//UNDERSCORE_CPP_STATIC_PIPELINE_HPP
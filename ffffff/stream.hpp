@@ -0,0 +1,477 @@
+#ifndef UNDERSCORE_CPP_STREAM_HPP
+#define UNDERSCORE_CPP_STREAM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <ranges>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "concurrency.hpp"
+#include "pipeline.hpp"
+
+/*
+* Bounded ring buffers
+*/
+namespace fff {
+
+    namespace liated {
+
+        constexpr auto ring_capacity(std::size_t n) noexcept -> std::size_t {
+            return std::bit_ceil(std::max<std::size_t>(2, n));
+        }
+    }
+
+    /**
+    * A bounded single-producer single-consumer queue. Each side caches the other side's index
+    * and only rereads it (one cache miss) when the cached value says the ring is full or empty.
+    * @tparam T a movable type
+    */
+    template<typename T>
+    class SpscRing {
+        std::size_t mask;
+        std::unique_ptr<std::optional<T>[]> slots;
+
+        alignas(cache_line_size) std::atomic<std::size_t> head{0};  // next slot to pop, written by the consumer
+        std::size_t tail_cache = 0;
+        alignas(cache_line_size) std::atomic<std::size_t> tail{0};  // next slot to push, written by the producer
+        std::size_t head_cache = 0;
+
+    public:
+        /**
+        * @param capacity rounded up to a power of two
+        */
+        explicit SpscRing(std::size_t capacity)
+            : mask(liated::ring_capacity(capacity) - 1), slots(new std::optional<T>[mask + 1]) {}
+
+        /**
+        * @return false, leaving v untouched, if the ring is full
+        */
+        bool try_push(T &v) {
+            const std::size_t t = tail.load(std::memory_order_relaxed);
+
+            if (t - head_cache > mask) {
+                head_cache = head.load(std::memory_order_acquire);
+                if (t - head_cache > mask) {
+                    return false;
+                }
+            }
+
+            slots[t & mask].emplace(std::move(v));
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        auto try_pop() -> std::optional<T> {
+            const std::size_t h = head.load(std::memory_order_relaxed);
+
+            if (h == tail_cache) {
+                tail_cache = tail.load(std::memory_order_acquire);
+                if (h == tail_cache) {
+                    return std::nullopt;
+                }
+            }
+
+            std::optional<T> v = std::move(slots[h & mask]);
+            slots[h & mask].reset();
+            head.store(h + 1, std::memory_order_release);
+            return v;
+        }
+
+        auto capacity() const noexcept -> std::size_t {
+            return mask + 1;
+        }
+    };
+
+    /**
+    * A bounded multi-producer multi-consumer queue (D. Vyukov's design): every slot has a sequence number
+    * that tells whether it is ready to be written or read in the current lap, so producers and consumers
+    * only contend on their own index.
+    * @tparam T a movable type
+    */
+    template<typename T>
+    class MpmcRing {
+        struct Slot {
+            std::atomic<std::size_t> seq;
+            std::optional<T> value;
+        };
+
+        std::size_t mask;
+        std::unique_ptr<Slot[]> slots;
+
+        alignas(cache_line_size) std::atomic<std::size_t> enqueue_pos{0};
+        alignas(cache_line_size) std::atomic<std::size_t> dequeue_pos{0};
+
+    public:
+        explicit MpmcRing(std::size_t capacity)
+            : mask(liated::ring_capacity(capacity) - 1), slots(new Slot[mask + 1])
+        {
+            for (std::size_t i = 0; i <= mask; ++i) {
+                slots[i].seq.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        bool try_push(T &v) {
+            std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+            Slot *slot;
+
+            for (;;) {
+                slot = &slots[pos & mask];
+                const std::size_t seq = slot->seq.load(std::memory_order_acquire);
+                const auto dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+
+                if (dif == 0) {
+                    if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (dif < 0) {
+                    return false;
+                } else {
+                    pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            slot->value.emplace(std::move(v));
+            slot->seq.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        auto try_pop() -> std::optional<T> {
+            std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+            Slot *slot;
+
+            for (;;) {
+                slot = &slots[pos & mask];
+                const std::size_t seq = slot->seq.load(std::memory_order_acquire);
+                const auto dif = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+
+                if (dif == 0) {
+                    if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (dif < 0) {
+                    return std::nullopt;
+                } else {
+                    pos = dequeue_pos.load(std::memory_order_relaxed);
+                }
+            }
+
+            std::optional<T> v = std::move(slot->value);
+            slot->value.reset();
+            slot->seq.store(pos + mask + 1, std::memory_order_release);
+            return v;
+        }
+
+        auto capacity() const noexcept -> std::size_t {
+            return mask + 1;
+        }
+    };
+}
+
+/*
+* fff::stream : every stage of a Pipeline on its own threads
+*/
+namespace fff {
+
+    struct stream_options {
+        /**
+        * The capacity of every queue between two stages; a full queue blocks the stage that feeds it.
+        */
+        std::size_t capacity = 1024;
+
+        /**
+        * The number of workers for each stage, 1 for the missing entries.
+        * Only stateless stages may get more than one, since the workers call the same function object.
+        */
+        std::vector<std::size_t> parallelism = {};
+
+        /**
+        * Whether the outputs reach the sink in input order. Only matters if a stage has several workers.
+        */
+        bool ordered = true;
+    };
+
+    namespace liated {
+
+        template<typename T>
+        struct StreamItem {
+            std::size_t seq;
+            T value;
+        };
+
+        /**
+        * A queue between two stages. SPSC when one thread feeds one thread, MPMC otherwise.
+        * The stream ends when every producer has called close() and the queue is drained.
+        */
+        template<typename T>
+        class Channel {
+            std::optional<SpscRing<T>> spsc;
+            std::optional<MpmcRing<T>> mpmc;
+            std::atomic<std::size_t> open_producers;
+
+        public:
+            Channel(std::size_t capacity, std::size_t producers, std::size_t consumers)
+                : open_producers(producers)
+            {
+                if (producers == 1 and consumers == 1) {
+                    spsc.emplace(capacity);
+                } else {
+                    mpmc.emplace(capacity);
+                }
+            }
+
+            /**
+            * Blocks while the queue is full.
+            * @return false if the stream was cancelled meanwhile
+            */
+            bool push(T v, const std::atomic<bool> &cancelled) {
+                Backoff backoff;
+                while (not (spsc ? spsc->try_push(v) : mpmc->try_push(v))) {
+                    if (cancelled.load(std::memory_order_relaxed)) {
+                        return false;
+                    }
+                    backoff.pause();
+                }
+                return true;
+            }
+
+            /**
+            * Blocks while the queue is empty and some producer is still open.
+            * @return nullopt at the end of the stream or if it was cancelled
+            */
+            auto pop(const std::atomic<bool> &cancelled) -> std::optional<T> {
+                Backoff backoff;
+                for (;;) {
+                    if (auto v = spsc ? spsc->try_pop() : mpmc->try_pop()) {
+                        return v;
+                    }
+                    if (open_producers.load(std::memory_order_acquire) == 0) {
+                        // a last push may have landed between the failed pop and the load
+                        return spsc ? spsc->try_pop() : mpmc->try_pop();
+                    }
+                    if (cancelled.load(std::memory_order_relaxed)) {
+                        return std::nullopt;
+                    }
+                    backoff.pause();
+                }
+            }
+
+            void close() noexcept {
+                open_producers.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        };
+
+        /**
+        * The element types flowing out of each stage, for an input of type In.
+        */
+        template<typename In, class ...Stages>
+        struct stream_chain {
+            using types = std::tuple<>;
+        };
+
+        template<typename In, class S, class ...Stages>
+        struct stream_chain<In, S, Stages...> {
+            using out = std::decay_t<decltype(call_stage(std::declval<const S &>(), std::declval<In>()))>;
+            static_assert(not std::is_void_v<out>, "fff::stream : every stage must return a value");
+
+            using types = decltype(std::tuple_cat(std::declval<std::tuple<out>>(),
+                                                  std::declval<typename stream_chain<out, Stages...>::types>()));
+        };
+
+        template<typename In, class ...Fs>
+        struct stream_types_of;
+
+        template<typename In, class ...Fs>
+        struct stream_types_of<In, Pipeline<Fs...>> {
+            // the values in every queue: the input, then the output of each stage
+            using types = decltype(std::tuple_cat(std::declval<std::tuple<In>>(),
+                                                  std::declval<typename stream_chain<In, Fs...>::types>()));
+        };
+
+        /**
+        * Records the first exception of any thread and cancels the stream.
+        */
+        struct StreamFailure {
+            std::atomic<bool> cancelled{false};
+            std::mutex m;
+            std::exception_ptr error;
+
+            void fail() noexcept {
+                const std::lock_guard lock(m);
+                if (not error) {
+                    error = std::current_exception();
+                }
+                cancelled.store(true, std::memory_order_relaxed);
+            }
+        };
+    }
+
+    namespace fs {
+        struct Stream_f {
+        private:
+            template<class P, typename Types, std::size_t ...I>
+            static auto make_channels(const stream_options &opt, const std::vector<std::size_t> &workers,
+                                      std::index_sequence<I...>)
+            {
+                // queue I is fed by stage I - 1 (the feeder thread for I == 0) and drained by stage I
+                // (the calling thread for the last one)
+                return std::make_tuple(std::make_unique<liated::Channel<liated::StreamItem<std::tuple_element_t<I, Types>>>>(
+                    opt.capacity,
+                    I == 0 ? 1 : workers[I - 1],
+                    I < P::size ? workers[I] : 1)...);
+            }
+
+        public:
+            /**
+            * Runs the pipeline over input with every stage on its own thread(s), connected by bounded queues.
+            * One thread feeds the first queue; each stage's workers pop from their queue, call the stage
+            * and push to the next one; the calling thread drains the last queue into sink.
+            * While a stage is slower than the one before, the queue between them fills up and blocks the producer,
+            * so memory stays bounded by the queue capacities.\n
+            * If a stage throws, the stream stops and the first exception is rethrown here.
+            * @param sink called on the calling thread with every output, in input order if opt.ordered
+            * @example fff::stream(decode | transform | encode, packets, [&](auto &&out) {write(out);}, {.parallelism = {1, 4, 1}})
+            */
+            template<class ...Fs, std::ranges::input_range R, class Sink>
+            void operator()(const Pipeline<Fs...> &pipeline, R &&input, Sink &&sink,
+                            const stream_options &opt = {}) const
+            {
+                using P = Pipeline<Fs...>;
+                using In = std::ranges::range_value_t<R>;
+                using Types = typename liated::stream_types_of<In, P>::types;
+
+                std::vector<std::size_t> workers(P::size, 1);
+                for (std::size_t i = 0; i < std::min(P::size, opt.parallelism.size()); ++i) {
+                    workers[i] = std::max<std::size_t>(1, opt.parallelism[i]);
+                }
+
+                auto channels = make_channels<P, Types>(opt, workers, std::make_index_sequence<P::size + 1>());
+                liated::StreamFailure failure;
+                const auto &cancelled = failure.cancelled;
+
+                {
+                    std::vector<std::jthread> threads;
+
+                    threads.emplace_back([&] {
+                        auto &ch = *std::get<0>(channels);
+                        try {
+                            std::size_t seq = 0;
+                            for (auto &&v : input) {
+                                if (not ch.push({seq++, static_cast<In>(std::forward<decltype(v)>(v))}, cancelled)) {
+                                    break;
+                                }
+                            }
+                        }
+                        catch (...) {
+                            failure.fail();
+                        }
+                        ch.close();
+                    });
+
+                    [&]<std::size_t ...I>(std::index_sequence<I...>) {
+                        (spawn_stage<I>(threads, pipeline, workers[I], channels, failure), ...);
+                    }(std::make_index_sequence<P::size>());
+
+                    drain(*std::get<P::size>(channels), sink, opt.ordered, failure);
+                }
+
+                if (failure.error) {
+                    std::rethrow_exception(failure.error);
+                }
+            }
+
+            /**
+            * Same as above, collecting the outputs into a std::vector.
+            */
+            template<class ...Fs, std::ranges::input_range R>
+            auto operator()(const Pipeline<Fs...> &pipeline, R &&input, const stream_options &opt = {}) const {
+                using In = std::ranges::range_value_t<R>;
+                using Types = typename liated::stream_types_of<In, Pipeline<Fs...>>::types;
+
+                std::vector<std::tuple_element_t<Pipeline<Fs...>::size, Types>> out;
+                if constexpr (std::ranges::sized_range<R>) {
+                    out.reserve(std::ranges::size(input));
+                }
+
+                operator()(pipeline, std::forward<R>(input), [&out](auto &&v) {
+                    out.push_back(std::forward<decltype(v)>(v));
+                }, opt);
+
+                return out;
+            }
+
+        private:
+            template<std::size_t I, class P, class Channels>
+            static void spawn_stage(std::vector<std::jthread> &threads, const P &pipeline, std::size_t n,
+                                    Channels &channels, liated::StreamFailure &failure)
+            {
+                for (std::size_t w = 0; w < n; ++w) {
+                    threads.emplace_back([&] {
+                        auto &from = *std::get<I>(channels);
+                        auto &to = *std::get<I + 1>(channels);
+                        const auto &stage = pipeline.template stage<I>();
+
+                        try {
+                            while (auto item = from.pop(failure.cancelled)) {
+                                if (not to.push({item->seq, liated::call_stage(stage, std::move(item->value))},
+                                                failure.cancelled)) {
+                                    break;
+                                }
+                            }
+                        }
+                        catch (...) {
+                            failure.fail();
+                        }
+                        to.close();
+                    });
+                }
+            }
+
+            template<class Channel, class Sink>
+            static void drain(Channel &ch, Sink &sink, bool ordered, liated::StreamFailure &failure) {
+                using Item = std::remove_cvref_t<decltype(*ch.pop(failure.cancelled))>;
+
+                auto later = [](const Item &a, const Item &b) {return a.seq > b.seq;};
+                std::priority_queue<Item, std::vector<Item>, decltype(later)> pending(later);
+                std::size_t next = 0;
+
+                try {
+                    while (auto item = ch.pop(failure.cancelled)) {
+                        if (not ordered) {
+                            std::invoke(sink, std::move(item->value));
+                            continue;
+                        }
+
+                        pending.push(std::move(*item));
+                        while (not pending.empty() and pending.top().seq == next) {
+                            // top() is const; the element is popped right after
+                            std::invoke(sink, std::move(const_cast<Item &>(pending.top()).value));
+                            pending.pop();
+                            ++next;
+                        }
+                    }
+                }
+                catch (...) {
+                    failure.fail();
+                    while (ch.pop(failure.cancelled)) {}
+                }
+            }
+        };
+    }
+
+    constexpr inline fs::Stream_f stream;
+}
+
+#endif//UNDERSCORE_CPP_STREAM_HPP
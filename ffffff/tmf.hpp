@@ -1,9 +1,13 @@
 #ifndef UNDERSCORE_CPP_TMF_HPP
 #define UNDERSCORE_CPP_TMF_HPP
 
-#include <type_traits>
+#include <array>
 #include <concepts>
+#include <cstddef>
 #include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace fff {
 
@@ -27,23 +31,142 @@ namespace fff {
     using type_of = std::decay_t<decltype(V)>;
 
     namespace liated {
-        template<unsigned int N, typename T = void, typename ...U>
-        struct among_impl {
-            using type = typename among_impl<N - 1, U...>::type;
-        };
+        /**
+        * type_pack\<T...> derives from type_leaf\<0, T0>, type_leaf\<1, T1>, ..., so the N-th type is found by
+        * deducing T in pick\<N> against the bases, in one step instead of N nested instantiations.
+        */
+        template<std::size_t I, typename T>
+        struct type_leaf {};
 
-        template<typename T, typename ...U>
-        struct among_impl<0, T, U...> {
-            using type = T;
-        };
+        template<typename Seq, typename ...T>
+        struct type_pack;
+
+        template<std::size_t ...I, typename ...T>
+        struct type_pack<std::index_sequence<I...>, T...> : type_leaf<I, T>... {};
+
+        template<std::size_t I, typename T>
+        auto pick(const type_leaf<I, T> &) noexcept -> std::type_identity<T>;
 
         template<typename ...T>
         struct among {
             template<unsigned int N>
-            using get = typename liated::among_impl<N, T...>::type;
+            using get = typename decltype(pick<N>(std::declval<type_pack<std::index_sequence_for<T...>, T...>>()))::type;
         };
 
         static_assert(std::is_same_v<int, among<char, double, int>::get<2>>);
+
+        /**
+        * The same layout holding values: value_pack\<T...> has one value_leaf\<I, Ti> base per element,
+        * and get_leaf\<I> reaches the I-th one directly. Empty elements take no space: a leaf derives from
+        * an empty, non-final T instead of holding one (a [[no_unique_address]] member could overlap, and be
+        * overwritten by, the leaf that follows it when the pack is initialized).
+        */
+        template<std::size_t I, typename T, bool = std::is_empty_v<T> and not std::is_final_v<T>>
+        struct value_leaf {
+            T value;
+
+            template<typename U>
+            constexpr explicit value_leaf(std::in_place_t, U &&u) : value(std::forward<U>(u)) {}
+        };
+
+        template<std::size_t I, typename T>
+        struct value_leaf<I, T, true> : T {
+            template<typename U>
+            constexpr explicit value_leaf(std::in_place_t, U &&u) : T(std::forward<U>(u)) {}
+        };
+
+        template<typename Seq, typename ...T>
+        struct value_pack;
+
+        template<std::size_t ...I, typename ...T>
+        struct value_pack<std::index_sequence<I...>, T...> : value_leaf<I, T>... {
+            template<typename ...U>
+            constexpr explicit value_pack(std::in_place_t, U &&...u)
+                : value_leaf<I, T>(std::in_place, std::forward<U>(u))... {}
+        };
+
+        template<typename ...T>
+        using flat_pack = value_pack<std::index_sequence_for<T...>, T...>;
+
+        template<std::size_t I, typename T, bool E>
+        constexpr auto get_leaf(value_leaf<I, T, E> &leaf) noexcept -> T & {
+            if constexpr (E) {
+                return static_cast<T &>(leaf);
+            } else {
+                return leaf.value;
+            }
+        }
+
+        template<std::size_t I, typename T, bool E>
+        constexpr auto get_leaf(const value_leaf<I, T, E> &leaf) noexcept -> const T & {
+            if constexpr (E) {
+                return static_cast<const T &>(leaf);
+            } else {
+                return leaf.value;
+            }
+        }
+
+        template<std::size_t I, typename T, bool E>
+        constexpr auto get_leaf(value_leaf<I, T, E> &&leaf) noexcept -> T && {
+            return std::move(get_leaf<I>(leaf));
+        }
+
+        template<std::size_t I, typename T, bool E>
+        constexpr auto get_leaf(const value_leaf<I, T, E> &&leaf) noexcept -> const T && {
+            return std::move(get_leaf<I>(leaf));
+        }
+
+        /**
+        * The index of the first true among B..., or sizeof...(B) if there is none.
+        */
+        template<bool ...B>
+        constexpr inline std::size_t first_true_v = [] {
+            constexpr std::array<bool, sizeof...(B)> b{B...};
+            for (std::size_t i = 0; i < b.size(); ++i) {
+                if (b[i]) {
+                    return i;
+                }
+            }
+            return b.size();
+        }();
+
+        static_assert(first_true_v<false, true, true> == 1 and first_true_v<false> == 1);
+
+        /**
+        * The argument types of a function with a single, non-template call signature.
+        */
+        template<typename F>
+        struct signature_args {};
+
+        template<typename F>
+            requires requires { &F::operator(); }
+        struct signature_args<F> : signature_args<decltype(&F::operator())> {};
+
+        template<typename R, typename ...Args>
+        struct signature_args<R(*)(Args...)> {
+            using type = std::tuple<Args...>;
+        };
+
+        template<typename R, typename ...Args>
+        struct signature_args<R(*)(Args...) noexcept> : signature_args<R(*)(Args...)> {};
+
+        template<typename R, typename ...Args>
+        struct signature_args<R(Args...)> : signature_args<R(*)(Args...)> {};
+
+        template<typename C, typename R, typename ...Args>
+        struct signature_args<R(C::*)(Args...)> : signature_args<R(*)(Args...)> {};
+
+        template<typename C, typename R, typename ...Args>
+        struct signature_args<R(C::*)(Args...) const> : signature_args<R(*)(Args...)> {};
+
+        template<typename C, typename R, typename ...Args>
+        struct signature_args<R(C::*)(Args...) noexcept> : signature_args<R(*)(Args...)> {};
+
+        template<typename C, typename R, typename ...Args>
+        struct signature_args<R(C::*)(Args...) const noexcept> : signature_args<R(*)(Args...)> {};
+
+        template<typename F>
+        concept has_signature = requires { typename signature_args<F>::type; };
     }
 
     template<unsigned int N, typename ...T>
@@ -127,8 +250,7 @@ namespace fff {
         */
         template<template<class> class C>
             requires unary_pred<C>
-        constexpr static const bool value = C<type>::value and
-            (std::is_void_v<next> or next::template value<C>);
+        constexpr static const bool value = C<type>::value and (C<Ts>::value and ...);
     };
 
     template<typename T>
@@ -183,7 +305,7 @@ namespace fff {
         requires unary_pred<Pred>
     struct every_type_satisfies {
         constexpr const static bool value =
-            std::is_void_v<T> or (Pred<T>::value and every_type_satisfies<Pred, Ts...>::value);
+            std::is_void_v<T> or (Pred<T>::value and (Pred<Ts>::value and ...));
     };
 
     template<template<class> class Pred, typename T = void, typename ...Ts>
@@ -306,12 +428,49 @@ namespace fff {
             cont.insert(0);
         };
 
+    template<typename T>
+    concept reservable =
+        requires (T cont, std::size_t n) {
+            cont.reserve(n);
+        };
+
+    template<typename T>
+    concept shrinkable =
+        requires (T cont) {
+            cont.shrink_to_fit();
+        };
+
     template<typename T>
     concept maybetype =
         requires {
             T::is_maybe;
         };
 
+    template<typename T>
+    concept expectedtype =
+        requires {
+            T::is_expected;
+        };
+
+    /**
+    * A range of records read from outside of memory (fff::MappedRecords, fff::ChunkedReader).
+    * The functors collect what they make out of one into a std::vector.
+    */
+    template<typename T>
+    concept record_source =
+        requires {
+            T::is_record_source;
+        };
+
+    /**
+    * fff::soa_vector and fff::soa_selection: the functors read them column by column.
+    */
+    template<typename T>
+    concept soatype =
+        requires {
+            T::is_soa;
+        };
+
     namespace fs {
         struct rvalue_detector_f {
             template<typename T>
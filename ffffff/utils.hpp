@@ -2,17 +2,32 @@
 #define UNDERSCORE_CPP_UTILS_HPP
 
 #include <type_traits>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
 
+#include "concurrency.hpp"
 #include "interfaces.hpp"
 #include "tmf.hpp"
 
 namespace fff::factory {
     class NL;
     class Count;
+    class ConcurrentCount;
     class Once;
+    class ConcurrentOnce;
+    class Throttle;
+    class Debounce;
+    class RateLimit;
 }
 
 namespace fff {
@@ -115,7 +130,99 @@ namespace fff {
             return self.memo = std::invoke(std::forward<Self>(self).f);
         }
 
-        constexpr static bool debug = true;
+        constexpr static bool debug = false;
+    };
+
+    template<void_invocable F>
+    class Once_f<F> : public callable_i<F, Once_f<F>, std::invoke_result> {
+        friend callable_i<F, Once_f<F>, std::invoke_result>;
+        friend factory::Once;
+
+        [[no_unique_address]]   F               f;
+                                mutable bool    flag;
+
+        constexpr explicit Once_f(const F &f) noexcept
+            : f(f),             flag(false) {}
+        constexpr explicit Once_f(F &&f) noexcept
+            : f(std::move(f)),  flag(false) {}
+
+        template<similar<Once_f<F>> Self>
+        constexpr static void call_impl(Self &&self)
+            noexcept(std::is_nothrow_invocable_v<F>)
+        {
+            if (self.flag) {
+                return;
+            }
+            self.flag = true;
+            std::invoke(std::forward<Self>(self).f);
+        }
+    };
+
+    namespace liated {
+        template<typename F, typename ...>
+        struct ConcurrentOnce_TD {
+            using type = const std::invoke_result_t<F> &;
+        };
+
+        template<void_invocable F, typename ...Args>
+        struct ConcurrentOnce_TD<F, Args...> {
+            using type = void;
+        };
+    }
+
+    /**
+    * Thread-safe version of Once_f: several threads may call it at the same time, f still runs exactly once
+    * and every caller sees its result.\n
+    * Once the result is published, a call costs a single acquire load. Until then, callers are serialized
+    * the way std::call_once does it (one runs f, the others wait); if f throws, the exception reaches
+    * that caller and the next call tries again.\n
+    * The slow path is a mutex rather than std::call_once, which never returns after an exceptional
+    * call on libstdc++ (GCC bug 66146).
+    * @warning returns a reference to the memoized value, which lives as long as the ConcurrentOnce_f
+    */
+    template<std::invocable F>
+    class ConcurrentOnce_f : public callable_i<F, ConcurrentOnce_f<F>, liated::ConcurrentOnce_TD> {
+        friend callable_i<F, ConcurrentOnce_f<F>, liated::ConcurrentOnce_TD>;
+        friend factory::ConcurrentOnce;
+
+        using R = std::invoke_result_t<F>;
+        using Memo = std::conditional_t<std::is_void_v<R>, null_t, std::optional<R>>;
+
+        [[no_unique_address]]   F                           f;
+        [[no_unique_address]]   mutable Memo                memo;
+                                mutable std::atomic<bool>   ready;
+                                mutable std::mutex          mtx;
+
+        explicit ConcurrentOnce_f(const F &f) noexcept
+            : f(f),             ready(false) {}
+        explicit ConcurrentOnce_f(F &&f) noexcept
+            : f(std::move(f)),  ready(false) {}
+
+        template<similar<ConcurrentOnce_f<F>> Self>
+        static auto call_impl(Self &&self)
+            -> typename liated::ConcurrentOnce_TD<F>::type
+        {
+            if (not self.ready.load(std::memory_order_acquire)) [[unlikely]] {
+                const std::lock_guard lock(self.mtx);
+
+                if (not self.ready.load(std::memory_order_relaxed)) {
+                    if constexpr (std::is_void_v<R>) {
+                        std::invoke(self.f);
+                    } else {
+                        self.memo.emplace(std::invoke(self.f));
+                    }
+                    self.ready.store(true, std::memory_order_release);
+                }
+            }
+
+            if constexpr (not std::is_void_v<R>) {
+                return *self.memo;
+            }
+        }
+
+    public:
+        ConcurrentOnce_f(const ConcurrentOnce_f &) = delete;
+        ConcurrentOnce_f &operator=(const ConcurrentOnce_f &) = delete;
     };
 
     namespace factory {
@@ -127,111 +234,562 @@ namespace fff {
                 return Once_f<std::decay_t<F>>{std::forward<F>(f)};
             }
         };
+
+        struct ConcurrentOnce {
+            template<std::invocable F>
+            auto operator()(F &&f) const noexcept
+                -> ConcurrentOnce_f<std::decay_t<F>>
+            {
+                return ConcurrentOnce_f<std::decay_t<F>>{std::forward<F>(f)};
+            }
+        };
     }
 
     constexpr inline factory::Once once;
+
+    /**
+    * @example static const auto table = fff::concurrent_once(build_table); ... table().at(key)
+    */
+    constexpr inline factory::ConcurrentOnce concurrent_once;
 }
 
 /* fff::Count_f Reducible_TD */
 namespace fff {
 
+    /**
+    * Counts how many times f is called.
+    * @warning the count is a plain integer: use concurrent_count if several threads call it
+    */
     template<class F>
     class Count_f {
-        friend class CountFactory;
+        friend factory::Count;
 
         [[no_unique_address]] F f;
-        mutable int cnt;
+        mutable std::uint64_t cnt;
 
         constexpr explicit Count_f(const F &f) noexcept : f(f), cnt(0) {}
         constexpr explicit Count_f(F &&f) noexcept : f(std::move(f)), cnt(0) {}
 
     public:
         template<class ...Args>
-            requires std::invocable<F, Args...>
-        constexpr auto operator()(Args ...args) const
-            noexcept(noexcept(std::invoke(f, std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
+            requires std::invocable<const F &, Args...>
+        constexpr auto operator()(Args &&...args) const
+            noexcept(std::is_nothrow_invocable_v<const F &, Args...>)
+                -> std::invoke_result_t<const F &, Args...>
         {
             ++cnt;
             return std::invoke(f, std::forward<Args>(args)...);
         }
-        constexpr int get_count() const noexcept {
+        constexpr auto get_count() const noexcept -> std::uint64_t {
             return cnt;
         }
     };
 
+    /**
+    * Counts how many times f is called, from any number of threads at once.
+    * The count lives in a StripedCounter that copies of the functor share, so a copy handed
+    * to a parallel algorithm still counts into the original.
+    */
+    template<class F>
+    class ConcurrentCount_f {
+        friend factory::ConcurrentCount;
+
+        [[no_unique_address]] F f;
+        std::shared_ptr<StripedCounter> cnt;
+
+        explicit ConcurrentCount_f(const F &f) : f(f), cnt(std::make_shared<StripedCounter>()) {}
+        explicit ConcurrentCount_f(F &&f) : f(std::move(f)), cnt(std::make_shared<StripedCounter>()) {}
+
+    public:
+        template<class ...Args>
+            requires std::invocable<const F &, Args...>
+        auto operator()(Args &&...args) const
+            noexcept(std::is_nothrow_invocable_v<const F &, Args...>)
+                -> std::invoke_result_t<const F &, Args...>
+        {
+            cnt->add();
+            return std::invoke(f, std::forward<Args>(args)...);
+        }
+        auto get_count() const noexcept -> std::uint64_t {
+            return cnt->load();
+        }
+        void reset_count() noexcept {
+            cnt->reset();
+        }
+    };
+
     namespace factory {
         struct Count {
             template<class F>
             constexpr auto operator()(F &&f) const noexcept
-                -> Count_f<F>
+                -> Count_f<std::decay_t<F>>
+            {
+                return Count_f<std::decay_t<F>>(std::forward<F>(f));
+            }
+        };
+
+        struct ConcurrentCount {
+            template<class F>
+            auto operator()(F &&f) const
+                -> ConcurrentCount_f<std::decay_t<F>>
             {
-                return Count_f<F>(std::forward<F>(f));
+                return ConcurrentCount_f<std::decay_t<F>>(std::forward<F>(f));
             }
         };
     }
 
     constexpr inline factory::Count count;
+    constexpr inline factory::ConcurrentCount concurrent_count;
+}
+
+/*
+* fff::throttle fff::debounce fff::rate_limit
+*/
+namespace fff {
+
+    namespace liated {
+
+        inline auto gate_now() noexcept -> std::int64_t {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        /**
+        * Lets a call through if interval has passed since the last call that got through.
+        */
+        struct alignas(cache_line_size) ThrottleGate {
+            std::atomic<std::int64_t> next;  // the earliest time the next call may go through
+            std::int64_t interval;
+
+            explicit ThrottleGate(std::int64_t interval) noexcept : next(0), interval(interval) {}
+
+            auto admit(std::int64_t now) noexcept -> bool {
+                std::int64_t n = next.load(std::memory_order_relaxed);
+                return now >= n and next.compare_exchange_strong(n, now + interval, std::memory_order_relaxed);
+            }
+        };
+
+        /**
+        * Lets a call through if no call came for interval before it, whether that call got through or not.
+        * A dropped call only writes the time down if it is more than interval / 64 later than the last one
+        * written, so that a burst of calls does not write the shared line on every call, and only if no other
+        * call wrote a later one meanwhile.
+        */
+        struct alignas(cache_line_size) DebounceGate {
+            std::atomic<std::int64_t> last;  // the time of the last call
+            std::int64_t interval;
+
+            explicit DebounceGate(std::int64_t interval) noexcept
+                : last(std::numeric_limits<std::int64_t>::min() / 2), interval(interval) {}
+
+            auto admit(std::int64_t now) noexcept -> bool {
+                std::int64_t l = last.load(std::memory_order_relaxed);
+                if (now - l >= interval) {
+                    return last.compare_exchange_strong(l, now, std::memory_order_relaxed);
+                }
+                if (now - l > interval / 64) {
+                    // never move last back past the time a racing call wrote
+                    while (now > l and not last.compare_exchange_weak(l, now, std::memory_order_relaxed)) {}
+                }
+                return false;
+            }
+        };
+
+        /**
+        * A token bucket in one word, as the generic cell rate algorithm (GCRA) keeps it: tat is the time at which
+        * the bucket would be full again. A call takes one token, i.e. pushes tat one period further, and is
+        * dropped if that would take more than burst tokens.
+        */
+        struct alignas(cache_line_size) RateGate {
+            std::atomic<std::int64_t> tat;
+            std::int64_t period;  // nanoseconds per token
+            std::int64_t limit;   // how far past now tat may go: burst periods
+
+            RateGate(std::int64_t period, std::int64_t burst) noexcept
+                : tat(std::numeric_limits<std::int64_t>::min() / 2), period(period), limit(period * burst) {}
+
+            auto admit(std::int64_t now) noexcept -> bool {
+                std::int64_t t = tat.load(std::memory_order_relaxed);
+                for (;;) {
+                    const std::int64_t next = std::max(t, now) + period;
+                    if (next - now > limit) {
+                        return false;
+                    }
+                    if (tat.compare_exchange_weak(t, next, std::memory_order_relaxed)) {
+                        return true;
+                    }
+                }
+            }
+        };
+
+        /**
+        * What a gated call returns: whether f ran, or what it returned if it did.
+        */
+        template<typename R>
+        struct gated_result {
+            using type = std::optional<std::remove_cvref_t<R>>;
+        };
+
+        template<>
+        struct gated_result<void> {
+            using type = bool;
+        };
+
+        template<typename R>
+        using gated_result_t = typename gated_result<R>::type;
+
+        /**
+        * f behind a Gate, which copies of the functor share: a copy handed to another thread is held back
+        * by the same gate. The time of a call is read once, and a dropped call does not touch f.
+        */
+        template<class F, class Gate>
+        class Gated_f {
+            friend factory::Throttle;
+            friend factory::Debounce;
+            friend factory::RateLimit;
+
+            [[no_unique_address]] F f;
+            std::shared_ptr<Gate> gate;
+
+            template<typename G, class ...GateArgs>
+            explicit Gated_f(G &&f, GateArgs ...gate_args)
+                : f(std::forward<G>(f)), gate(std::make_shared<Gate>(gate_args...)) {}
+
+        public:
+            template<class ...Args>
+                requires std::invocable<const F &, Args...>
+            auto operator()(Args &&...args) const
+                noexcept(std::is_nothrow_invocable_v<const F &, Args...>
+                         and (std::is_void_v<std::invoke_result_t<const F &, Args...>>
+                              or std::is_nothrow_constructible_v<
+                                     gated_result_t<std::invoke_result_t<const F &, Args...>>,
+                                     std::invoke_result_t<const F &, Args...>>))
+                -> gated_result_t<std::invoke_result_t<const F &, Args...>>
+            {
+                using R = std::invoke_result_t<const F &, Args...>;
+
+                if (not gate->admit(gate_now())) {
+                    return {};
+                }
+                if constexpr (std::is_void_v<R>) {
+                    std::invoke(f, std::forward<Args>(args)...);
+                    return true;
+                } else {
+                    return std::invoke(f, std::forward<Args>(args)...);
+                }
+            }
+        };
+    }
+
+    /**
+    * underscore.js's throttle (leading edge): f runs at most once per interval, from any number of threads.
+    * A call that comes too soon is dropped, for one relaxed load and no write.
+    * @return a function that returns std::optional of what f returns (bool for void f): empty if the call was dropped
+    * @example const auto flush = fff::throttle(flush_metrics, std::chrono::seconds(1));
+    */
+    template<class F>
+    using Throttle_f = liated::Gated_f<F, liated::ThrottleGate>;
+
+    /**
+    * underscore.js's debounce with immediate = true: f runs for a call that comes after at least interval without
+    * calls, and a burst of calls closer together than that runs f once, for its first call.
+    * @return as throttle
+    * @warning the trailing edge (running f once a burst is over) needs a timer, and is not what this does
+    */
+    template<class F>
+    using Debounce_f = liated::Gated_f<F, liated::DebounceGate>;
+
+    /**
+    * f runs for at most per_second calls a second on average, with bursts of up to burst calls.
+    * The calls above the rate are dropped for one relaxed load and no write.
+    * @return as throttle
+    * @throw std::invalid_argument if per_second is not a positive number
+    */
+    template<class F>
+    using RateLimit_f = liated::Gated_f<F, liated::RateGate>;
+
+    namespace factory {
+        struct Throttle {
+            template<class F>
+            auto operator()(F &&f, std::chrono::nanoseconds interval) const -> Throttle_f<std::decay_t<F>> {
+                return Throttle_f<std::decay_t<F>>(std::forward<F>(f), interval.count());
+            }
+        };
+
+        struct Debounce {
+            template<class F>
+            auto operator()(F &&f, std::chrono::nanoseconds interval) const -> Debounce_f<std::decay_t<F>> {
+                return Debounce_f<std::decay_t<F>>(std::forward<F>(f), interval.count());
+            }
+        };
+
+        struct RateLimit {
+            template<class F>
+            auto operator()(F &&f, double per_second, std::int64_t burst = 1) const -> RateLimit_f<std::decay_t<F>> {
+                if (not (per_second > 0)) {
+                    throw std::invalid_argument("fff::rate_limit : per_second must be a positive number");
+                }
+                burst = std::max<std::int64_t>(1, burst);
+                // burst periods must fit in a time, far from the ends of std::int64_t
+                const auto longest = static_cast<double>(std::numeric_limits<std::int64_t>::max() / 4 / burst);
+                const auto period = static_cast<std::int64_t>(std::clamp(1e9 / per_second, 1.0, longest));
+                return RateLimit_f<std::decay_t<F>>(std::forward<F>(f), period, burst);
+            }
+        };
+    }
+
+    constexpr inline factory::Throttle throttle;
+    constexpr inline factory::Debounce debounce;
+    constexpr inline factory::RateLimit rate_limit;
 }
 
 /*
 * fff::Fly Reducible_TD
 */
 namespace fff {
+
+    /**
+    * How a Fly keeps its function object.
+    * automatic : inline if it is small (see fly_inline), otherwise on the heap, copied deeply.
+    * shared : on the heap, shared by copies, copied only when a copy is about to be mutated.
+    */
+    enum class fly_storage {
+        automatic,
+        shared,
+    };
+
+    /**
+    * Whether a Fly\<F> keeps F inline: at most three pointers big, not over-aligned, and nothrow movable,
+    * so that moving the Fly stays noexcept as it is in the heap case.
+    */
     template<class F>
+    constexpr inline bool fly_inline = sizeof(F) <= 3 * sizeof(void *)
+        and alignof(F) <= alignof(std::max_align_t)
+        and std::is_nothrow_move_constructible_v<F>;
+
+    namespace liated {
+
+        /**
+        * F kept in place. Assigning it makes F again when F cannot be assigned, as a capturing lambda cannot,
+        * so that a Fly stays assignable either way.
+        */
+        template<class F>
+        class FlyInline {
+            mutable F f;
+
+        public:
+            template<class G>
+            explicit FlyInline(G &&g) : f(std::forward<G>(g)) {}
+
+            FlyInline(const FlyInline &) = default;
+            FlyInline(FlyInline &&) noexcept = default;
+
+            FlyInline &operator=(const FlyInline &other)
+                requires std::copy_constructible<F>
+            {
+                if constexpr (std::is_copy_assignable_v<F>) {
+                    f = other.f;
+                } else if (this != &other) {
+                    F copy(other.f);
+                    std::destroy_at(&f);
+                    std::construct_at(&f, std::move(copy));
+                }
+                return *this;
+            }
+
+            FlyInline &operator=(FlyInline &&other) noexcept {
+                if constexpr (std::is_nothrow_move_assignable_v<F>) {
+                    f = std::move(other.f);
+                } else if (this != &other) {
+                    std::destroy_at(&f);
+                    std::construct_at(&f, std::move(other.f));
+                }
+                return *this;
+            }
+
+            auto get() const noexcept -> F & {
+                return f;
+            }
+        };
+
+        template<class F>
+        class FlyHeap {
+            std::unique_ptr<F> p;
+
+        public:
+            template<class G>
+            explicit FlyHeap(G &&g) : p(std::make_unique<F>(std::forward<G>(g))) {}
+
+            FlyHeap(const FlyHeap &other) : p(std::make_unique<F>(*other.p)) {}
+            FlyHeap(FlyHeap &&) noexcept = default;
+            FlyHeap &operator=(const FlyHeap &other) {
+                p = std::make_unique<F>(*other.p);
+                return *this;
+            }
+            FlyHeap &operator=(FlyHeap &&) noexcept = default;
+
+            auto get() const noexcept -> F & {
+                return *p;
+            }
+        };
+
+        template<class F>
+        class FlyShared {
+            std::shared_ptr<F> p;
+
+        public:
+            template<class G>
+            explicit FlyShared(G &&g) : p(std::make_shared<F>(std::forward<G>(g))) {}
+
+            auto get() const noexcept -> const F & {
+                return *p;
+            }
+
+            /**
+            * Copies the shared F first if another Fly still refers to it.
+            */
+            auto get_mut() -> F & {
+                if (p.use_count() > 1) {
+                    p = std::make_shared<F>(std::as_const(*p));
+                }
+                return *p;
+            }
+
+            auto use_count() const noexcept -> long {
+                return p.use_count();
+            }
+        };
+
+        template<class F, fly_storage S>
+        using fly_storage_t = std::conditional_t<S == fly_storage::shared,
+                                                 FlyShared<F>,
+                                                 std::conditional_t<fly_inline<F>, FlyInline<F>, FlyHeap<F>>>;
+    }
+
+    /**
+    * A function object with value semantics that is cheap to copy around.\n
+    * With fly_storage::automatic, a small F is kept inline (no allocation at all) and a big one on the heap.
+    * With fly_storage::shared, copies share one F and pay a reference count increment;
+    * a call that needs a mutable F (a mutable lambda) first gives this Fly its own copy.
+    * @warning a shared Fly is not thread-safe to mutate while other threads use copies of it
+    */
+    template<class F, fly_storage S = fly_storage::automatic>
     class Fly {
-        std::unique_ptr<F> p;
+        liated::fly_storage_t<F, S> storage;
 
     public:
-        explicit Fly(const F &f) : p(new F(f)) {}
-        explicit Fly(F &&f) : p(new F(std::move(f))) {}
-
-        Fly(const Fly &fly) : p(new F(*fly.p)) {}
-        Fly(Fly &&fly) noexcept = default;
-        Fly &operator=(const Fly &fly) {
-            p = std::make_unique<F>(*fly.p);
-            return *this;
+        constexpr static fly_storage storage_kind = S;
+        constexpr static bool is_inline = S == fly_storage::automatic and fly_inline<F>;
+
+        explicit Fly(const F &f) : storage(f) {}
+        explicit Fly(F &&f) : storage(std::move(f)) {}
+
+        template<class ...Args>
+            requires std::invocable<F &, Args...>
+                     and (S == fly_storage::automatic)
+        auto operator()(Args &&...args) const
+            noexcept(std::is_nothrow_invocable_v<F &, Args...>)
+                -> std::invoke_result_t<F &, Args...>
+        {
+            return std::invoke(storage.get(), std::forward<Args>(args)...);
         }
-        Fly &operator=(Fly &&) noexcept = default;
 
         template<class ...Args>
-            requires std::invocable<F, Args...>
+            requires std::invocable<const F &, Args...>
+                     and (S == fly_storage::shared)
         auto operator()(Args &&...args) const
-            noexcept(noexcept(std::invoke(*p, std::forward<Args>(args)...)))
-                -> std::invoke_result_t<F, Args...>
+            noexcept(std::is_nothrow_invocable_v<const F &, Args...>)
+                -> std::invoke_result_t<const F &, Args...>
+        {
+            return std::invoke(storage.get(), std::forward<Args>(args)...);
+        }
+
+        template<class ...Args>
+            requires std::invocable<F &, Args...> and (not std::invocable<const F &, Args...>)
+                     and (S == fly_storage::shared)
+        auto operator()(Args &&...args)
+            -> std::invoke_result_t<F &, Args...>
         {
-            return std::invoke(*p, std::forward<Args>(args)...);
+            return std::invoke(storage.get_mut(), std::forward<Args>(args)...);
         }
 
+        /**
+        * The number of Flys sharing this F; always 1 unless shared.
+        */
+        auto use_count() const noexcept -> long {
+            if constexpr (S == fly_storage::shared) {
+                return storage.use_count();
+            } else {
+                return 1;
+            }
+        }
     };
 
     struct FlyFactory {
         template<class F>
-        constexpr auto operator()(F &&f) const noexcept -> Fly<std::decay_t<F>> {
+        constexpr auto operator()(F &&f) const -> Fly<std::decay_t<F>> {
             return Fly<std::decay_t<F>>(std::forward<F>(f));
         }
     };
+
+    struct SharedFlyFactory {
+        template<class F>
+        constexpr auto operator()(F &&f) const -> Fly<std::decay_t<F>, fly_storage::shared> {
+            return Fly<std::decay_t<F>, fly_storage::shared>(std::forward<F>(f));
+        }
+    };
+
+    constexpr inline FlyFactory fly;
+
+    /**
+    * @example auto f = fff::shared_fly([table = std::move(big_table)](int k) {return table.at(k);});
+    */
+    constexpr inline SharedFlyFactory shared_fly;
 }
 
 namespace fff {
 
+    template<typename T>
+        requires std::default_initializable<T> and std::move_constructible<T>
+    class pool;
+
+    /**
+    * Counts the objects of a class that derives from ObjectCounter of itself: created() counts constructions
+    * and copies, alive() the objects that exist now. A move is not a creation: the new object takes the place
+    * of the moved-from one. recycled() counts the objects fff::pool\<T> handed out again instead of making new ones.
+    * The counts are atomic, so objects may live on any thread.
+    */
     template<typename T>
     class ObjectCounter {
-        inline static int created_ = 0, alive_ = 0;
+        inline static std::atomic<int> created_ = 0, alive_ = 0, recycled_ = 0;
+
+        template<typename U>
+            requires std::default_initializable<U> and std::move_constructible<U>
+        friend class pool;
 
     public:
         constexpr ObjectCounter() noexcept {
-            ++created_; ++alive_;
+            created_.fetch_add(1, std::memory_order_relaxed);
+            alive_.fetch_add(1, std::memory_order_relaxed);
+        }
+        constexpr ObjectCounter(const ObjectCounter &) noexcept : ObjectCounter() {}
+        constexpr ObjectCounter(ObjectCounter &&) noexcept {
+            alive_.fetch_add(1, std::memory_order_relaxed);
         }
+        constexpr ObjectCounter &operator=(const ObjectCounter &) noexcept = default;
+        constexpr ObjectCounter &operator=(ObjectCounter &&) noexcept = default;
         constexpr ~ObjectCounter() noexcept {
-            --alive_;
+            alive_.fetch_sub(1, std::memory_order_relaxed);
         }
 
         [[nodiscard]] static int created() noexcept {
-            return created_;
+            return created_.load(std::memory_order_relaxed);
         }
         [[nodiscard]] static int alive() noexcept {
-            return alive_;
+            return alive_.load(std::memory_order_relaxed);
+        }
+        [[nodiscard]] static int recycled() noexcept {
+            return recycled_.load(std::memory_order_relaxed);
         }
 
         constexpr explicit operator bool() const noexcept {